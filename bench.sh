@@ -0,0 +1,169 @@
+#!/bin/sh
+# Benchmark: generates a data file of N records and times, through the program's own
+# batch and server modes,
+#   load    reading and parsing the text file (MB/s)
+#   lookup  roll searches on the loaded list
+#   sort    ordering by marks and by name, over an unsorted listing of the same records
+#   serve   throughput of a --serve process answering many concurrent --client streams
+# Each timing is the best of RUNS runs. The program is treated as a black box, so the
+# same script measures any build: run it once with BIN pointing at the old binary and
+# once at the new one to get before/after numbers.
+#
+# Usage: ./bench.sh [RECORDS] [LOOKUPS] [CLIENTS]     (defaults 99999, 100000, 128)
+# Environment: BIN (default: build student_records.c with -O2), RUNS (default 3),
+#              COMMANDS per serve client (default 300)
+
+set -eu
+
+RECORDS=${1:-99999}
+LOOKUPS=${2:-100000}
+CLIENTS=${3:-128}
+RUNS=${RUNS:-3}
+COMMANDS=${COMMANDS:-300}
+
+[ "$RECORDS" -ge 1 ] && [ "$RECORDS" -le 99999 ] || {
+    echo "RECORDS must be 1..99999 (the roll number range)" >&2
+    exit 1
+}
+
+SRC_DIR=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+SERVER_PID=
+
+cleanup() {
+    if [ -n "$SERVER_PID" ]; then
+        kill "$SERVER_PID" 2>/dev/null || true
+    fi
+    rm -rf "$WORK"
+}
+trap cleanup EXIT
+
+if [ -z "${BIN:-}" ]; then
+    BIN=$WORK/student_records
+    cc -std=c11 -O2 -pthread -o "$BIN" "$SRC_DIR/student_records.c"
+fi
+
+now() {
+    date +%s.%N
+}
+
+# Prints the fastest of RUNS runs of the command, in seconds
+best_of() {
+    best=
+    run=0
+    while [ $run -lt "$RUNS" ]; do
+        start=$(now)
+        "$@" > /dev/null 2>&1
+        end=$(now)
+        best=$(awk -v s="$start" -v e="$end" -v b="$best" \
+            'BEGIN { t = e - s; if (b == "" || t < b) b = t; printf "%.4f", b }')
+        run=$((run + 1))
+    done
+    echo "$best"
+}
+
+# Runs batch commands from a file against a fresh copy of the data file, so no run
+# benefits from a journal or index left behind by the one before
+batch() {
+    cp "$WORK/data.txt" "$WORK/run.txt"
+    rm -f "$WORK/run.txt.log" "$WORK/run.txt.idx"
+    "$BIN" --batch "$1" --file="$WORK/run.txt"
+}
+
+# Rolls are shuffled so neither the file nor the lookups go in roll order
+awk -v n="$RECORDS" 'BEGIN {
+    srand(42)
+    for (i = 1; i <= n; i++) roll[i] = i
+    for (i = n; i > 1; i--) { j = 1 + int(rand() * i); t = roll[i]; roll[i] = roll[j]; roll[j] = t }
+    print "# Student Record System Data File"
+    print "# Format: roll|marks|name"
+    print "# Total records: " n
+    for (i = 1; i <= n; i++) {
+        name = sprintf("%c%c%c Student %d", 65 + int(rand() * 26), 97 + int(rand() * 26),
+                       97 + int(rand() * 26), roll[i])
+        printf "%d|%d|%s\n", roll[i], int(rand() * 101), name
+    }
+}' > "$WORK/data.txt"
+
+awk -v n="$RECORDS" -v k="$LOOKUPS" 'BEGIN {
+    srand(7)
+    for (i = 0; i < k; i++) printf "find %d\n", 1 + int(rand() * n)
+}' > "$WORK/lookups.cmds"
+
+echo "# load only" > "$WORK/empty.cmds"
+echo "list" > "$WORK/list.cmds"
+echo "list marks" > "$WORK/marks.cmds"
+echo "list name" > "$WORK/name.cmds"
+
+bytes=$(wc -c < "$WORK/data.txt")
+echo "Benchmarking $BIN"
+echo "$RECORDS records ($bytes bytes), best of $RUNS runs"
+echo
+
+t_load=$(best_of batch "$WORK/empty.cmds")
+t_lookup=$(best_of batch "$WORK/lookups.cmds")
+t_list=$(best_of batch "$WORK/list.cmds")
+t_marks=$(best_of batch "$WORK/marks.cmds")
+t_name=$(best_of batch "$WORK/name.cmds")
+
+awk -v b="$bytes" -v t="$t_load" -v n="$RECORDS" 'BEGIN {
+    printf "load    %8.1f ms  %8.1f MB/s  (%d records)\n", t * 1000, b / t / 1e6, n
+}'
+awk -v t="$t_lookup" -v l="$t_load" -v k="$LOOKUPS" 'BEGIN {
+    d = t - l; if (d < 1e-6) d = 1e-6
+    printf "lookup  %8.1f ms  %8.0f ns each  (%d finds, load subtracted)\n", d * 1000, d / k * 1e9, k
+}'
+awk -v m="$t_marks" -v a="$t_name" -v l="$t_list" 'BEGIN {
+    printf "sort    %8.1f ms  by marks, %.1f ms by name  (over an unsorted listing)\n",
+           (m - l) * 1000, (a - l) * 1000
+}'
+
+# Serve: CLIENTS concurrent clients, each sending COMMANDS commands, one mod to three finds
+cp "$WORK/data.txt" "$WORK/serve.txt"
+"$BIN" --serve --file="$WORK/serve.txt" --socket="$WORK/sock" > /dev/null 2>&1 &
+SERVER_PID=$!
+tries=0
+while [ ! -S "$WORK/sock" ]; do
+    tries=$((tries + 1))
+    if [ $tries -gt 100 ]; then
+        echo "serve: server did not start" >&2
+        exit 1
+    fi
+    sleep 0.1
+done
+
+c=0
+while [ $c -lt "$CLIENTS" ]; do
+    awk -v c=$c -v n="$COMMANDS" -v r="$RECORDS" 'BEGIN {
+        srand(c + 100)
+        for (i = 0; i < n; i++) {
+            if (i % 4 == 0) printf "mod %d %d %d Bench %d\n", 1 + (c * n + i) % r, 1 + (c * n + i) % r, i % 101, c
+            else printf "find %d\n", 1 + int(rand() * r)
+        }
+    }' > "$WORK/serve$c.cmds"
+    c=$((c + 1))
+done
+
+start=$(now)
+c=0
+pids=
+while [ $c -lt "$CLIENTS" ]; do
+    "$BIN" --client --socket="$WORK/sock" < "$WORK/serve$c.cmds" > /dev/null 2>&1 &
+    pids="$pids $!"
+    c=$((c + 1))
+done
+failed=0
+for pid in $pids; do
+    wait "$pid" || failed=$((failed + 1))
+done
+end=$(now)
+
+kill -TERM "$SERVER_PID"
+wait "$SERVER_PID" || true
+SERVER_PID=
+
+awk -v s="$start" -v e="$end" -v c="$CLIENTS" -v n="$COMMANDS" -v f="$failed" 'BEGIN {
+    t = e - s
+    printf "serve   %8.1f ms  %8.0f commands/s  (%d clients x %d commands, %d clients failed)\n",
+           t * 1000, c * n / t, c, n, f
+}'
@@ -0,0 +1,154 @@
+#!/bin/sh
+# Server stress test: starts student_records --serve on a seeded data file, runs 16
+# concurrent --client streams with 95% reads and 5% writes, then checks that the
+# server's indexes agree with its records ("check") and that the saved file holds
+# exactly the records the clients' writes should have left.
+#
+# Usage: ./stress_server.sh [COMMANDS_PER_CLIENT] [SEED_RECORDS]
+# Set BIN to test an existing binary instead of building student_records.c, and
+# TIMEOUT (seconds, default 300) to change how long the clients may take.
+# Exits non-zero on the first failed assertion, including a hang.
+
+set -eu
+
+COMMANDS=${1:-500}
+SEED=${2:-2000}
+CLIENTS=16
+TIMEOUT=${TIMEOUT:-300}
+
+SRC_DIR=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+SERVER_PID=
+
+cleanup() {
+    if [ -n "$SERVER_PID" ]; then
+        kill "$SERVER_PID" 2>/dev/null || true
+    fi
+    rm -rf "$WORK"
+}
+trap cleanup EXIT
+
+fail() {
+    echo "FAIL: $*" >&2
+    exit 1
+}
+
+if [ -z "${BIN:-}" ]; then
+    BIN=$WORK/student_records
+    cc -std=c11 -O2 -pthread -o "$BIN" "$SRC_DIR/student_records.c"
+fi
+
+DATA=$WORK/students.txt
+SOCK=$WORK/students.sock
+
+awk -v n="$SEED" 'BEGIN {
+    print "# Student Record System Data File"
+    print "# Format: roll|marks|name"
+    print "# Total records: " n
+    for (i = 1; i <= n; i++) printf "%d|%d|Seed Student %d\n", i, i % 101, i
+}' > "$DATA"
+
+"$BIN" --serve --file="$DATA" --socket="$SOCK" > "$WORK/server.out" 2> "$WORK/server.err" &
+SERVER_PID=$!
+
+tries=0
+while [ ! -S "$SOCK" ]; do
+    tries=$((tries + 1))
+    [ $tries -le 100 ] || fail "server did not start: $(cat "$WORK/server.err")"
+    sleep 0.1
+done
+
+# Each client owns rolls 10000 + c * 5000 and up, so its writes never collide with
+# another client's and the final record count is known in advance. Reads go to the
+# seeded rolls, which nobody changes. The generator prints the client's net change
+# in records on its last line
+c=0
+while [ $c -lt $CLIENTS ]; do
+    awk -v c=$c -v n="$COMMANDS" -v seed="$SEED" 'BEGIN {
+        srand(c + 1)
+        base = 10000 + c * 5000
+        live = 0; next_roll = base
+        for (i = 0; i < n; i++) {
+            r = rand()
+            if (r < 0.95) {
+                k = int(rand() * 20)
+                if (k < 14)      printf "find %d\n", 1 + int(rand() * seed)
+                else if (k < 16) print "stats"
+                else if (k < 17) print "check"
+                else if (k < 18) print "list"
+                else if (k < 19) print "list name"
+                else             print "list desc"
+            } else {
+                w = int(rand() * 3)
+                if (w == 0 || live == 0) {
+                    printf "add %d %d Client %d Student %d\n", next_roll, int(rand() * 101), c, next_roll
+                    rolls[live++] = next_roll++
+                } else if (w == 1) {
+                    printf "mod %d %d %d Client %d Renamed\n", rolls[live - 1], rolls[live - 1], int(rand() * 101), c
+                } else {
+                    printf "del %d\n", rolls[--live]
+                }
+            }
+        }
+        printf "#net %d\n", live
+    }' > "$WORK/client$c.cmds"
+    c=$((c + 1))
+done
+
+start=$(date +%s.%N)
+c=0
+while [ $c -lt $CLIENTS ]; do
+    ( status=0
+      "$BIN" --client --socket="$SOCK" < "$WORK/client$c.cmds" > /dev/null 2> "$WORK/client$c.err" ||
+          status=$?
+      echo $status > "$WORK/client$c.status" ) &
+    c=$((c + 1))
+done
+# Polled rather than waited for, so a stuck server fails the test instead of hanging it
+deadline=$(($(date +%s) + TIMEOUT))
+done_clients=0
+while [ $done_clients -lt $CLIENTS ]; do
+    if [ -f "$WORK/client$done_clients.status" ]; then
+        done_clients=$((done_clients + 1))
+        continue
+    fi
+    [ "$(date +%s)" -lt $deadline ] || fail "only $done_clients of $CLIENTS clients finished within ${TIMEOUT}s"
+    sleep 0.05
+done
+elapsed=$(awk -v s="$start" -v e="$(date +%s.%N)" 'BEGIN { printf "%.2f", e - s }')
+
+expected=$SEED
+c=0
+while [ $c -lt $CLIENTS ]; do
+    status=$(cat "$WORK/client$c.status")
+    [ "$status" -eq 0 ] || fail "client $c exited with $status: $(head -3 "$WORK/client$c.err")"
+    net=$(sed -n 's/^#net //p' "$WORK/client$c.cmds")
+    expected=$((expected + net))
+    c=$((c + 1))
+done
+
+check=$(echo check | "$BIN" --client --socket="$SOCK") || fail "check failed on the server: $check"
+echo "$check" | grep -qx "Consistent: $expected records" ||
+    fail "server reports '$check', expected $expected records"
+
+kill -TERM "$SERVER_PID"
+tries=0
+while kill -0 "$SERVER_PID" 2>/dev/null; do
+    tries=$((tries + 1))
+    [ $tries -le 300 ] || fail "server did not stop within 30s of SIGTERM"
+    sleep 0.1
+done
+status=0
+wait "$SERVER_PID" || status=$?
+SERVER_PID=
+[ $status -eq 0 ] || fail "server exited with $status: $(cat "$WORK/server.err")"
+
+saved=$(grep -c '^[0-9]' "$DATA")
+[ "$saved" -eq "$expected" ] || fail "saved file holds $saved records, expected $expected"
+
+reload=$(echo check | "$BIN" --batch - --file="$DATA" 2>&1) || fail "reloading the saved file: $reload"
+echo "$reload" | grep -qx "Consistent: $expected records" ||
+    fail "reloaded file reports '$reload', expected $expected records"
+
+echo "PASS: $CLIENTS clients x $COMMANDS commands (95% reads) in ${elapsed}s," \
+     "$expected records consistent in memory and on disk"
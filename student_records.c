@@ -9,22 +9,79 @@
  - Optimized user experience with clear messages
 
  Compile(for me):
-   gcc -std=c11 -O2 -Wall -Wextra -Wpedantic -o student_records student_records.c
+   gcc -std=c11 -O2 -Wall -Wextra -Wpedantic -pthread -o student_records student_records.c
+ Add -march=native to let the file parser use AVX2 (SSE2 is used on any x86-64 build).
 
  Author: our Group
 */
+/*POSIX is needed for stat() and the other file system calls below*/
+#define _POSIX_C_SOURCE 200809L
+
 /*Here, we include all needed libraries*/
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include <errno.h>
+#include <stdint.h>
+#include <limits.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <locale.h>
+#include <pthread.h>
+#include <time.h>
+#include <signal.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/*x86 vector intrinsics for the record parser; other targets use its scalar path*/
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #define INITIAL_CAPACITY 8
+#define INITIAL_INDEX_CAPACITY 16
+#define MIN_ROLL 1
+#define MAX_ROLL 99999
 #define PASS_THRESHOLD 40
+#define MAX_MARKS 100
 #define MAX_NAME_LENGTH 100
 #define MAX_LINE_LENGTH 1024
 #define FILENAME "students.txt"
+#define ARENA_BLOCK_SIZE (64 * 1024)
+#define ARENA_ALIGN 8
+#define NAME_SIZE_CLASS 16
+#define NAME_CLASS_COUNT (MAX_LINE_LENGTH / NAME_SIZE_CLASS + 1)
+#define JOURNAL_SUFFIX ".log"
+#define JOURNAL_COMPACT_MIN_BYTES (64 * 1024)
+#define JOURNAL_COMPACT_RATIO 4  // Compact once the journal passes 1/4 of the data file
+#define BINARY_EXTENSION ".bin"
+#define BINARY_MAGIC "SRECBIN"
+#define BINARY_VERSION 1
+#define SCAN_BUFFER_SIZE (1024 * 1024)
+#define SIDECAR_SUFFIX ".idx"
+#define SIDECAR_MAGIC "SRECIDX"
+#define SIDECAR_VERSION 2
+#define BINARY_MAX_NAME UINT16_MAX // BinaryRow.name_length is 16 bits; longer names need the text format
+#define BINARY_ROW_DELETED 0x01    // BinaryRow.flags of a removed record's row (its roll is 0 too)
+#define BINARY_MIN_ROW_SLACK 64    // Spare rows a full binary save reserves for later additions,
+#define BINARY_ROW_SLACK_DIVISOR 8 // at least this many or 1/8 of the records
+#define BINARY_REWRITE_FRACTION 4  // Rewrite in full once 1/4 of the file would change or is dead
+#define SOCKET_PATH "students.sock"  // Where --serve listens and --client connects by default
+#define SERVER_FLUSH_MS 50            // How often the server hands unsaved changes to the saver
+#define LOCK_SUFFIX ".lock"  // Advisory lock file next to the data file (see File Locking)
+#define TEMP_SUFFIX ".tmpXXXXXX"  // mkstemp template for files being replaced (see Atomic File Replacement)
+#define MAX_SCAN_THREADS 64
+#define OUTPUT_BUFFER_SIZE (256 * 1024)
+#define PAGE_SIZE 20
+#define MAX_PAGE_SIZE 1000
+#define PARALLEL_SCAN_MIN_CHUNK (4 * SCAN_BUFFER_SIZE)  // Smallest byte range worth its own thread
 
 typedef enum {
     SUCCESS = 0,
@@ -32,7 +89,8 @@ typedef enum {
     ERR_NOT_FOUND,
     ERR_DUPLICATE,
     ERR_FILE_IO,
-    ERR_INVALID_INPUT
+    ERR_INVALID_INPUT,
+    ERR_CONFLICT  // The data file changed since we read it; saving would overwrite that
 } ErrorCode;
 
 /* We created a function that stores induvidual student data*/
@@ -41,17 +99,411 @@ typedef struct {
     int roll;
     char *name;
     int marks;
+    int32_t row;  // Row in the binary data file (see Incremental Save), -1 when not stored there
+    int dirty;    // Changed since it was last written to that row
 } Student;
 
+/* Index that maps a roll number to its slot in items, so lookups and duplicate checks
+   don't have to walk the whole array. Rolls entered through the menu are bounded to
+   MIN_ROLL..MAX_ROLL, so a dense table is used while that holds; a roll outside the range
+   switches it to an open-addressing hash table (linear probing) */
+typedef enum {
+    INDEX_DIRECT = 0,
+    INDEX_HASH
+} RollIndexMode;
+
+typedef struct {
+    int roll;
+    long index;  // -1 marks an empty bucket
+} RollIndexEntry;
+
+typedef struct {
+    RollIndexMode mode;
+    int32_t *direct;           // Direct mode: slot per roll, -1 when absent
+    RollIndexEntry *buckets;   // Hash mode
+    size_t capacity;           // Hash mode, always a power of two
+    size_t count;
+} RollIndex;
+
+/* On-disk layout of the binary record format: a header, fixed-width rows, then a heap
+   holding every name back to back. Rows can be read straight out of a mapped file */
+typedef struct {
+    char magic[8];           // BINARY_MAGIC
+    uint32_t version;
+    uint32_t row_size;       // sizeof(BinaryRow), so a foreign layout is rejected
+    uint64_t record_count;
+    uint64_t row_capacity;   // Rows reserved before the name heap (>= record_count)
+    uint64_t names_offset;   // File offset of the name heap
+    uint64_t names_size;
+} BinaryHeader;
+
+typedef struct {
+    int32_t roll;
+    uint32_t name_offset;    // Relative to the start of the name heap
+    uint16_t name_length;
+    uint8_t marks;
+    uint8_t flags;           // BINARY_ROW_DELETED for a tombstone, otherwise 0
+} BinaryRow;
+
+/* What a binary data file looked like after the list last loaded or saved it, so the next
+   save can write only the changes (see Incremental Save) */
+typedef struct {
+    int valid;               // The fields below describe last_filename as it is on disk
+    uint64_t record_count;   // Rows in use, tombstones included
+    uint64_t row_capacity;
+    uint64_t names_offset;
+    uint64_t names_size;
+    uint64_t dead_bytes;     // Name heap bytes that no live row points at any more
+    uint64_t deleted_rows;   // Tombstones already in the file
+    uint64_t *tombstones;    // Rows of records removed since, still live in the file
+    size_t tombstone_count;
+    size_t tombstone_capacity;
+} BinaryStore;
+
+_Static_assert(sizeof(BinaryHeader) == 48, "BinaryHeader must not contain padding");
+_Static_assert(sizeof(BinaryRow) == 12, "BinaryRow must not contain padding");
+
+/* Sorted roll index written next to a text data file (FILENAME.idx) */
+typedef struct {
+    char magic[8];            // SIDECAR_MAGIC
+    uint32_t version;
+    uint32_t entry_size;
+    uint64_t data_size;       // Size and mtime of the data file the entries describe
+    int64_t data_mtime_sec;
+    int64_t data_mtime_nsec;
+    uint64_t data_dev;        // ...and its identity, so a file copied or renamed over it
+    uint64_t data_ino;        // with the same size and mtime doesn't pass for it
+    uint64_t count;
+} SidecarHeader;
+
+typedef struct {
+    int32_t roll;
+    uint32_t line;            // Line number, for the "Found at line" message
+    uint64_t offset;          // Byte offset of the line in the data file
+} SidecarEntry;
+
+_Static_assert(sizeof(SidecarHeader) == 64, "SidecarHeader must not contain padding");
+_Static_assert(sizeof(SidecarEntry) == 16, "SidecarEntry must not contain padding");
+
+/* A binary record file mapped into memory for reading */
+typedef struct {
+    void *base;
+    size_t length;
+    const BinaryHeader *header;
+    const BinaryRow *rows;
+    const char *names;
+} BinaryMap;
+
+/* Block reader used by every function that parses a text data file */
+typedef struct {
+    int fd;
+    char *buf;           // cap bytes plus room for a terminator
+    size_t cap;          // SCAN_BUFFER_SIZE, doubled for each longer line met
+    size_t len;          // Bytes currently in buf
+    size_t pos;          // Start of the next line in buf
+    off_t buf_offset;    // File offset of buf[0]
+    off_t read_offset;   // File offset of the next pread
+    off_t end;           // Stop reading here (-1 for end of file)
+    size_t line_num;
+    char skipped[24];    // Stands in for a line too long to hold in memory
+} LineScanner;
+
+typedef enum {
+    PARSE_RECORD = 0,
+    PARSE_SKIP,          // Comment or blank line
+    PARSE_BAD_FORMAT,    // Missing a '|' separator
+    PARSE_BAD_DATA       // Roll or marks out of range
+} ParseResult;
+
+typedef struct {
+    int roll;
+    int marks;
+    char *name;          // Trimmed, NUL-terminated inside the scanner's buffer
+    size_t name_len;
+} ParsedRecord;
+
+/* How import_from_file settles a roll that appears more than once */
+typedef enum {
+    IMPORT_KEEP_FIRST = 0,   // The record already in the list, else the earliest row, wins
+    IMPORT_KEEP_LAST,        // The latest row wins, replacing a record already in the list
+    IMPORT_REJECT            // Any duplicate cancels the whole import
+} ImportPolicy;
+
+/* One parsed row of a bulk import, waiting for duplicates to be settled */
+typedef struct {
+    Student *student;
+    size_t source;       // Line (text) or record (binary) number in the imported file
+    size_t winner;       // For a losing row: the row that won, 0 when the list's record did
+    long replaces;       // Slot in items a keep-last row takes over, -1 when appended
+    int keep;
+} ImportRow;
+
+typedef struct {
+    ImportRow *rows;
+    size_t count;
+    size_t capacity;
+    const char *unit;    // "line" or "record", for messages
+} ImportBatch;
+
+typedef struct {
+    size_t added;
+    size_t replaced;
+    size_t skipped;
+    size_t invalid;
+} ImportSummary;
+
+/* Running totals for the statistics printed from a file */
+typedef struct {
+    size_t count;
+    long total;
+    int min;
+    int max;
+    int pass;
+    int fail;
+} MarksSummary;
+
+/* Rows formatted for one write() at a time (see Buffered Output) */
+typedef struct {
+    char *data;
+    size_t len;
+    int fd;
+    int failed;  // A write failed; later output is dropped
+} OutputBuffer;
+
+/* Draws records [first, first + count) of some listing into out, for run_pager */
+typedef void (*PageRenderer)(void *ctx, size_t first, size_t count, OutputBuffer *out);
+
+/* Where each record of a file starts: byte offsets for text, row numbers for binary */
+typedef struct {
+    uint64_t *positions;
+    size_t count;
+    size_t capacity;
+} RecordIndex;
+
+/* A file being paged through by display_from_file */
+typedef struct {
+    int fd;
+    const BinaryMap *map;  // NULL for text files
+    RecordIndex index;
+} FilePage;
+
+/* One worker's share of a parallel statistics scan */
+typedef struct {
+    int fd;
+    off_t start;
+    off_t end;
+    MarksSummary sum;
+    ErrorCode err;
+} StatsChunk;
+
+/* Kinds of change recorded in the write-ahead journal (the letter is what goes in the file) */
+typedef enum {
+    JOURNAL_ADD = 'A',
+    JOURNAL_MODIFY = 'M',
+    JOURNAL_DELETE = 'D'
+} JournalOp;
+
+/* Identity of a data file at the moment we last read or wrote it. If any of these differ
+   from a fresh stat(), someone else has changed the file since */
+typedef struct {
+    int valid;
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    time_t mtime_sec;
+    long mtime_nsec;
+} FileStamp;
+
+/* An advisory lock held on a data file's lock file, or fd -1 when running without one */
+typedef struct {
+    int fd;
+} FileLock;
+
+/* Bump allocator that owns every Student struct and name string in a list.
+   Freed records and names go on free lists so later adds and renames reuse them */
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t size;
+    size_t used;
+    unsigned char data[];
+} ArenaBlock;
+
+typedef struct FreeNode {
+    struct FreeNode *next;
+} FreeNode;
+
+typedef struct {
+    ArenaBlock *blocks;                      // Newest block first
+    FreeNode *free_students;                 // Recycled Student structs
+    FreeNode *free_names[NAME_CLASS_COUNT];  // Recycled name buffers, one list per size class
+} Arena;
+
+/* How names are ordered when sorting by name */
+typedef enum {
+    COLLATE_BYTES,   // Plain strcmp order (the default)
+    COLLATE_NOCASE,  // ASCII case-insensitive
+    COLLATE_LOCALE   // strcoll order for the LC_COLLATE locale from the environment
+} CollationMode;
+
+/* How hard save_to_file works to make a save survive a crash of the whole machine */
+typedef enum {
+    SAVE_DURABLE,    // fsync the new file and its directory before reporting success (the default)
+    SAVE_FAST        // Still replaced atomically, but flushing to disk is left to the kernel
+} SaveMode;
+
+/* Time the last save_to_file spent formatting records and making them durable */
+typedef struct {
+    double write_ms;
+    double sync_ms;
+    uint64_t bytes;  // Written to the data file
+} SaveTiming;
+
+/* A file being replaced: writes go to temp_path, which atomic_commit renames over target */
+typedef struct {
+    FILE *f;
+    char *temp_path;
+    const char *target;
+} AtomicFile;
+
+/* Orders that menu options 7, 8 and 9 display */
+typedef enum {
+    VIEW_MARKS_ASC,
+    VIEW_MARKS_DESC,
+    VIEW_NAME
+} StudentView;
+
+/* A copy of every record, handed to the background saver (see Background Save) */
+typedef struct {
+    uint64_t generation;  // Later snapshots have larger numbers
+    char *filename;
+    Student **items;      // items[i] points into records
+    Student *records;
+    char *names;          // Every name, NUL-terminated, back to back
+    size_t size;
+    FileStamp base;       // The data file and journal the list was last in sync with,
+    FileStamp journal;    // invalid when unknown (see File Locking)
+} SaveSnapshot;
+
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t lock;     // Guards everything below
+    pthread_cond_t wake;      // Signalled when a snapshot is handed over or on stop
+    pthread_cond_t idle;      // Broadcast whenever the saver finishes a write
+    SaveSnapshot *pending;    // Newest snapshot not picked up yet
+    int busy;                 // A snapshot is being written
+    int stop;
+    int failed;               // A write failed since the main thread last looked
+    int conflict;             // ...because the file had been changed by another program
+    uint64_t requested;       // Generation of the newest snapshot handed over
+    uint64_t written;         // Generation of the last snapshot written successfully
+    size_t coalesced;         // Snapshots replaced before they were written
+    FileStamp stamp;          // The data file as our last write left it, successful or not
+    FileStamp journal;        // ...and its journal
+    int stamped;              // stamp and journal are newer than what the list knows
+    SaveMode mode;
+} AsyncSaver;
+
 /*Then this part is the function "studentList" structure */
+/* items keeps one record handle per student; rolls and marks mirror the same fields as
+   dense columns in the same order, so scans (statistics, sorting, index rebuilds) stream
+   through contiguous memory instead of following one pointer per record */
 typedef struct {
     Student **items;
+    int32_t *rolls;   // rolls[i] == items[i]->roll
+    uint8_t *marks;   // marks[i] == items[i]->marks
+    RollIndex index;  // This property gives O(1) roll lookups
+    Arena arena;      // This property owns the Student structs and their names
+    size_t marks_hist[MAX_MARKS + 1];  // Students per mark, kept current for O(1) statistics
+    long marks_total;
+    size_t pass_count;
     size_t size;
     size_t capacity;
     int modified;  // This property tracks unsaved changes
     char *last_filename;  // This property helps to remember the last used filename
+    FileStamp file_stamp;  // This property records what last_filename looked like when we last synced
+    FileStamp journal_stamp;  // Same for the journal next to it (invalid when there is none)
+    int journaled;  // This property makes single changes go to the journal instead of a full save
+    CollationMode collation;  // This property picks the name order used by option 9
+    SaveMode save_mode;  // Durable or fast full saves (see Atomic File Replacement)
+    SaveTiming last_save;  // What the last save cost, for reporting
+    BinaryStore store;  // Where each record sits in a binary data file, for incremental saves
+    AsyncSaver *saver;  // Background writer for single changes with --async-save, else NULL
+    int conflict;  // A save was refused because another program changed the file; a load clears it
+    Student **by_name;   // Sorted view by name, then roll (see Sorted Views)
+    Student **by_marks;  // Sorted view by marks, then name, then roll
+    int views_valid;     // by_name and by_marks are built and current
 } StudentList;
 
+/* Readers-writer lock that lets a waiting writer in ahead of readers arriving after it,
+   so a steady stream of reads cannot hold changes back forever (see Server Mode) */
+typedef struct {
+    pthread_rwlock_t rw;
+    pthread_mutex_t turnstile;  // Held by a writer while it waits; new readers queue on it
+} RosterLock;
+
+/* State shared by the threads of --serve (see Server Mode) */
+typedef struct {
+    StudentList *list;
+    const char *filename;
+    RosterLock lock;  // Shared for commands that only read list, exclusive for the rest
+    pthread_mutex_t clients_lock;   // Guards clients and client_count
+    pthread_cond_t clients_done;    // Signalled when the last client thread is leaving
+    struct ServerClient *clients;   // Connected clients, so stopping can hang up on them
+    size_t client_count;
+} RosterServer;
+
+typedef struct ServerClient {
+    int fd;
+    RosterServer *server;
+    struct ServerClient *prev;
+    struct ServerClient *next;
+} ServerClient;
+
+/* One student's sort key when ordering by name: the first 8 bytes of its collation key
+   packed big-endian, so most comparisons are a single integer compare */
+typedef struct {
+    uint64_t prefix;
+    const char *key;  // Full collation key, compared only when prefixes tie
+    Student *student;
+} NameSortKey;
+
+/* A sorted view being paged through by display_all_students */
+typedef struct {
+    const StudentList *list;
+    StudentView view;
+} ViewPage;
+
+/* Keeps the best K students seen so far. The root is the worst of them, so a better
+   candidate replaces it in O(log K) */
+typedef struct {
+    Student **items;
+    size_t size;
+    size_t capacity;  // K
+    int top;          // 1 ranks the highest marks first, 0 the lowest
+    CollationMode collation;
+} RankHeap;
+
+/* Student records copied out of a file for top_k_from_file: K in the heap plus one spare */
+typedef struct {
+    Student *slots;
+    size_t *name_caps;  // Bytes allocated for each slot's name
+    size_t used;        // Slots handed out so far
+    Student *spare;
+} RankSlots;
+
+/* Settings taken from the command line */
+typedef struct {
+    CollationMode collation;
+    int scan_threads;  // Worker threads for statistics_from_file
+    const char *batch_path;  // Commands file for batch mode ("-" for stdin), NULL when interactive
+    const char *data_file;   // File batch mode works on
+    SaveMode save_mode;
+    int async_save;          // Single changes are written by a background thread
+    int serve;               // Run as a server for --client processes
+    int client;              // Send commands from stdin to a server
+    const char *socket_path;
+} ProgramOptions;
+
 /* ---------- Function Prototypes ---------- */
 
 static char *safe_strdup(const char *s);
@@ -59,11 +511,42 @@ static char *safe_strdup(const char *s);
 static char *read_line(const char *prompt);
 static void trim_inplace(char *s);
 static ErrorCode init_student_list(StudentList *list);
-static void free_student(Student *s);
+static void free_student(StudentList *list, Student *s);
 static void free_student_list(StudentList *list);
 static ErrorCode ensure_capacity(StudentList *list);
-static Student *create_student(int roll, const char *name, int marks);
+static void refresh_columns(StudentList *list);
+static void stats_add(StudentList *list, int marks);
+static void stats_remove(StudentList *list, int marks);
+static void stats_reset(StudentList *list);
+static int list_in_sync(const StudentList *list, const char *filename);
+static ErrorCode file_stamp_read(const char *filename, FileStamp *out);
+static ErrorCode sync_with_file(StudentList *list, const char *filename);
+static ErrorCode journal_append(StudentList *list, const char *filename,
+                                JournalOp op, int roll, const Student *s);
+static size_t journal_replay(StudentList *list, const char *filename);
+static void journal_stamp_read(const char *filename, FileStamp *out);
+static int journal_stamp_matches(const FileStamp *known, const FileStamp *current);
+static void journal_remove(const char *filename);
+static ErrorCode compact_journal(StudentList *list, const char *filename);
+static int is_binary_filename(const char *filename);
+static char *sidecar_path(const char *filename, const char *suffix);
+static void sidecar_write(const char *filename, SidecarEntry *entries, size_t count,
+                          const FileStamp *data);
+static ErrorCode binary_map_open(const char *filename, BinaryMap *map);
+static void binary_map_close(BinaryMap *map);
+static Student *create_student(StudentList *list, int roll, const char *name, int marks);
 static long find_index_by_roll(const StudentList *list, int roll);
+/*Roll number hash index*/
+static ErrorCode roll_index_init(RollIndex *idx);
+static void roll_index_free(RollIndex *idx);
+static ErrorCode roll_index_insert(RollIndex *idx, int roll, long index);
+static void roll_index_remove(RollIndex *idx, int roll);
+static void roll_index_set(RollIndex *idx, int roll, long index);
+static ErrorCode roll_index_rebuild(StudentList *list);
+static ErrorCode remember_filename(StudentList *list, const char *filename);
+static int async_save_settle(StudentList *list, int wait);
+static ErrorCode async_save_submit(StudentList *list, const char *filename);
+static void async_save_stop(StudentList *list);
 /*The core operations of the code*/
 /*Topics we learnt from school were added here: creare, read, update, delete*/
 static ErrorCode add_student(StudentList *list, Student *s);
@@ -75,14 +558,20 @@ static ErrorCode modify_student(
     const char *new_name, 
     int new_marks);
 static void display_student(const Student *s);
-static void display_all_students(const StudentList *list);
-static void display_statistics(const StudentList *list);
+static ErrorCode display_all_students(StudentList *list, StudentView view);
+static void display_statistics(const StudentList *list, FILE *out);
+static int pager_enabled(void);
+static ErrorCode run_pager(size_t total, PageRenderer render, void *ctx);
+static ErrorCode page_from_file(const char *filename, int fd, const BinaryMap *map);
 /*File I/O*/
 static ErrorCode save_to_file(StudentList *list, const char *filename);
+static ErrorCode import_from_file(StudentList *list, const char *filename, ImportPolicy policy,
+                                  ImportSummary *summary);
 static ErrorCode load_from_file(StudentList *list, const char *filename); /*/*Here was edited to work in a way that displays students directly from the file*/
 static ErrorCode display_from_file(const char *filename);
 static ErrorCode search_in_file(const char *filename, int roll);
-static ErrorCode statistics_from_file(const char *filename);
+static ErrorCode statistics_from_file(const char *filename, int threads);
+static ErrorCode top_k_from_file(const char *filename, size_t k, int top, CollationMode collation);
 static Student *search_by_roll(const StudentList *list, int roll);
 
 /*Sorting and Display*/
@@ -91,6 +580,21 @@ static int cmp_marks_asc(const void *a, const void *b);
 static int cmp_marks_desc(const void *a, const void *b);
 static int cmp_name_asc(const void *a, const void *b);
 static void sort_students(StudentList *list, int (*cmp)(const void*, const void*));
+static ErrorCode display_top_k(const StudentList *list, size_t k, int top);
+static ErrorCode rank_heap_init(RankHeap *h, size_t k, int top, CollationMode collation);
+static void rank_heap_free(RankHeap *h);
+static Student *rank_heap_offer(RankHeap *h, Student *s);
+static int rank_heap_wants_marks(const RankHeap *h, int marks);
+static void rank_heap_sort(RankHeap *h);
+static void display_ranked(const RankHeap *h);
+static void counting_sort_by_marks(Student **src, Student **dst, size_t n);
+static ErrorCode sort_by_name_keys(Student **items, size_t n, CollationMode mode);
+static void views_add(StudentList *list, Student *s, size_t count);
+static void views_drop(StudentList *list, const Student *s, size_t count);
+static void views_invalidate(StudentList *list);
+static ErrorCode views_build(StudentList *list);
+static void view_walk(const StudentList *list, StudentView view,
+                      void (*visit)(Student *s, size_t pos, void *ctx), void *ctx);
 static int prompt_yes_no(const char *prompt);
 static void auto_save_prompt(StudentList *list);
 static int prompt_int(const char *prompt, int min, int max);
@@ -179,6 +683,102 @@ static void trim_inplace(char *s) {
     }
 }
 
+/* ---------- Arena Allocator ---------- */
+
+/* Allocations are carved out of large blocks by bumping an offset, so loading N students
+   costs a handful of mallocs instead of 2N, and the whole arena is released in one go */
+static void *arena_alloc(Arena *arena, size_t size) {
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+    ArenaBlock *block = arena->blocks;
+
+    if (!block || block->size - block->used < size) {
+        size_t block_size = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+        block = malloc(sizeof(ArenaBlock) + block_size);
+
+        if (!block) {
+            return NULL;
+        }
+
+        block->size = block_size;
+        block->used = 0;
+        block->next = arena->blocks;
+        arena->blocks = block;
+    }
+
+    void *p = block->data + block->used;
+    block->used += size;
+    return p;
+}
+
+/* Name buffers are handed out in NAME_SIZE_CLASS steps so a freed one can be reused
+   by any later name of the same class */
+static size_t name_class(size_t bytes) {
+    return (bytes + NAME_SIZE_CLASS - 1) / NAME_SIZE_CLASS;
+}
+
+static char *arena_alloc_name(Arena *arena, const char *name) {
+    size_t bytes = strlen(name) + 1;
+    size_t cls = name_class(bytes);
+    char *buf;
+
+    if (cls < NAME_CLASS_COUNT && arena->free_names[cls]) {
+        buf = (char *)arena->free_names[cls];
+        arena->free_names[cls] = arena->free_names[cls]->next;
+    } else {
+        buf = arena_alloc(arena, cls * NAME_SIZE_CLASS);
+        if (!buf) {
+            return NULL;
+        }
+    }
+
+    memcpy(buf, name, bytes);
+    return buf;
+}
+
+/* Puts a name buffer on its size class's free list. Names too long for any class are
+   simply left in the arena until the next reset */
+static void arena_free_name(Arena *arena, char *name) {
+    if (!name) {
+        return;
+    }
+
+    size_t cls = name_class(strlen(name) + 1);
+
+    if (cls < NAME_CLASS_COUNT) {
+        FreeNode *node = (FreeNode *)name;
+        node->next = arena->free_names[cls];
+        arena->free_names[cls] = node;
+    }
+}
+
+/* Releases every block except the newest one, which is kept for the next load */
+static void arena_reset(Arena *arena) {
+    ArenaBlock *keep = arena->blocks;
+
+    if (keep) {
+        ArenaBlock *block = keep->next;
+
+        while (block) {
+            ArenaBlock *next = block->next;
+            free(block);
+            block = next;
+        }
+
+        keep->next = NULL;
+        keep->used = 0;
+    }
+
+    arena->free_students = NULL;
+    memset(arena->free_names, 0, sizeof(arena->free_names));
+}
+
+static void arena_release(Arena *arena) {
+    arena_reset(arena);
+    free(arena->blocks);
+    arena->blocks = NULL;
+}
+
 /* ---------- StudentList Management ---------- */
 
 static ErrorCode init_student_list(StudentList *list) {
@@ -190,18 +790,51 @@ static ErrorCode init_student_list(StudentList *list) {
     list->size = 0;
     list->modified = 0;
     list->last_filename = NULL;
+    list->file_stamp.valid = 0;
+    list->journal_stamp.valid = 0;
+    list->journaled = 1;
+    list->collation = COLLATE_BYTES;
+    list->save_mode = SAVE_DURABLE;
+    list->last_save.write_ms = 0;
+    list->last_save.sync_ms = 0;
+    list->last_save.bytes = 0;
+    memset(&list->store, 0, sizeof(list->store));
+    list->saver = NULL;
+    list->conflict = 0;
+    list->by_name = NULL;
+    list->by_marks = NULL;
+    list->views_valid = 0;
+    memset(&list->arena, 0, sizeof(list->arena));
+    stats_reset(list);
     list->items = calloc(list->capacity, sizeof(Student*));
-    
-    return list->items ? SUCCESS : ERR_MEMORY;
+    list->rolls = malloc(list->capacity * sizeof(int32_t));
+    list->marks = malloc(list->capacity * sizeof(uint8_t));
+
+    if (!list->items || !list->rolls || !list->marks ||
+        roll_index_init(&list->index) != SUCCESS) {
+        free(list->items);
+        free(list->rolls);
+        free(list->marks);
+        list->items = NULL;
+        list->rolls = NULL;
+        list->marks = NULL;
+        return ERR_MEMORY;
+    }
+
+    return SUCCESS;
 }
 
-static void free_student(Student *s) {
+/* Hands a student and its name back to the list's arena for reuse */
+static void free_student(StudentList *list, Student *s) {
     if (!s) {
         return;
     }
 
-    free(s->name);
-    free(s);
+    arena_free_name(&list->arena, s->name);
+
+    FreeNode *node = (FreeNode *)s;
+    node->next = list->arena.free_students;
+    list->arena.free_students = node;
 }
 
 static void free_student_list(StudentList *list) {
@@ -209,753 +842,5558 @@ static void free_student_list(StudentList *list) {
         return;
     }
 
-    for (size_t i = 0; i < list->size; i++) {
-        free_student(list->items[i]);
-    }
-
+    async_save_stop(list);  // Anything still pending is written first
+    arena_release(&list->arena);
     free(list->items);
+    free(list->rolls);
+    free(list->marks);
+    free(list->by_name);
+    free(list->by_marks);
     free(list->last_filename);
+    free(list->store.tombstones);
+    roll_index_free(&list->index);
     list->items = NULL;
+    list->rolls = NULL;
+    list->marks = NULL;
+    list->by_name = NULL;
+    list->by_marks = NULL;
+    list->views_valid = 0;
     list->last_filename = NULL;
     list->size = 0;
     list->capacity = 0;
     list->modified = 0;
 }
 
-/* This block does: it automatically expands the array when it gets full 
-   so we don't have to manually manage the size every time */
-static ErrorCode ensure_capacity(StudentList *list) {
+/* Grows every per-student array to hold at least needed records, doubling so a run of
+   appends stays cheap; bulk imports reserve their whole batch up front */
+static ErrorCode reserve_capacity(StudentList *list, size_t needed) {
     if (!list) {
         return ERR_INVALID_INPUT;
     }
 
-    if (list->size < list->capacity) {
+    if (needed <= list->capacity) {
         return SUCCESS;
     }
 
-    size_t new_capacity = list->capacity * 2;
+    size_t new_capacity = list->capacity ? list->capacity : INITIAL_CAPACITY;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+
     Student **tmp = realloc(list->items, new_capacity * sizeof(Student*));
 
     if (!tmp) {
         return ERR_MEMORY;
     }
-
     list->items = tmp;
+
+    int32_t *rolls = realloc(list->rolls, new_capacity * sizeof(int32_t));
+    if (!rolls) {
+        return ERR_MEMORY;
+    }
+    list->rolls = rolls;
+
+    uint8_t *marks = realloc(list->marks, new_capacity * sizeof(uint8_t));
+    if (!marks) {
+        return ERR_MEMORY;
+    }
+    list->marks = marks;
+
+    // The views grow with items; if they can't, they are simply rebuilt on next use
+    if (list->by_name) {
+        Student **by_name = realloc(list->by_name, new_capacity * sizeof(Student*));
+        Student **by_marks = by_name ? realloc(list->by_marks, new_capacity * sizeof(Student*)) : NULL;
+
+        list->by_name = by_name ? by_name : list->by_name;
+        list->by_marks = by_marks ? by_marks : list->by_marks;
+
+        if (!by_name || !by_marks) {
+            free(list->by_name);
+            free(list->by_marks);
+            list->by_name = NULL;
+            list->by_marks = NULL;
+            views_invalidate(list);
+        }
+    }
+
     list->capacity = new_capacity;
     return SUCCESS;
 }
 
-/* ---------- Student Operations ---------- */
+/* This block does: it automatically expands the array when it gets full 
+   so we don't have to manually manage the size every time */
+static ErrorCode ensure_capacity(StudentList *list) {
+    if (!list) {
+        return ERR_INVALID_INPUT;
+    }
 
-static Student *create_student(int roll, const char *name, int marks) {
-    Student *student = malloc(sizeof(Student));
+    return reserve_capacity(list, list->size + 1);
+}
 
-    if (!student) {
-        return NULL;
+/* These keep the running totals behind display_statistics current, one student at a time */
+static void stats_add(StudentList *list, int marks) {
+    list->marks_hist[marks]++;
+    list->marks_total += marks;
+    if (marks >= PASS_THRESHOLD) {
+        list->pass_count++;
     }
-    
-    student->roll = roll;
-    student->name = safe_strdup(name ? name : "Unnamed");
-    student->marks = marks;
+}
 
-    if (!student->name) {
-        free(student);
-        return NULL;
+static void stats_remove(StudentList *list, int marks) {
+    list->marks_hist[marks]--;
+    list->marks_total -= marks;
+    if (marks >= PASS_THRESHOLD) {
+        list->pass_count--;
     }
+}
 
-    return student;
+static void stats_reset(StudentList *list) {
+    memset(list->marks_hist, 0, sizeof(list->marks_hist));
+    list->marks_total = 0;
+    list->pass_count = 0;
 }
 
-static long find_index_by_roll(const StudentList *list, int roll) {
-    if (!list) {
-        return -1;
+/* These keep the per-record change tracking behind incremental binary saves current */
+static void store_reset(StudentList *list) {
+    list->store.valid = 0;
+    list->store.dead_bytes = 0;
+    list->store.deleted_rows = 0;
+    list->store.tombstone_count = 0;
+}
+
+/* Called before a record's fields change; the name its row points at becomes dead space */
+static void store_touch(StudentList *list, Student *s) {
+    if (s->row >= 0 && !s->dirty) {
+        list->store.dead_bytes += strlen(s->name);
     }
+    s->dirty = 1;
+}
 
-    for (size_t i = 0; i < list->size; i++) {
-        if (list->items[i]->roll == roll) {
-            return (long)i;
+/* Called when a record leaves the list; its row is blanked on the next save */
+static void store_forget(StudentList *list, Student *s) {
+    BinaryStore *st = &list->store;
+
+    if (s->row < 0) {
+        return;
+    }
+    store_touch(list, s);
+
+    if (st->tombstone_count == st->tombstone_capacity) {
+        size_t new_capacity = st->tombstone_capacity ? st->tombstone_capacity * 2 : 64;
+        uint64_t *tombstones = realloc(st->tombstones, new_capacity * sizeof(uint64_t));
+
+        if (!tombstones) {
+            st->valid = 0;  // A full save doesn't need the list
+            return;
         }
+        st->tombstones = tombstones;
+        st->tombstone_capacity = new_capacity;
     }
 
-    return -1;
+    st->tombstones[st->tombstone_count++] = (uint64_t)s->row;
 }
 
-/* This part checks for duplicates before adding, so we don't have two students with the same roll number */
-static ErrorCode add_student(StudentList *list, Student *s) {
-    if (!list || !s) {
-        return ERR_INVALID_INPUT;
+/* Re-derives the dense columns from items after the array has been reordered */
+static void refresh_columns(StudentList *list) {
+    for (size_t i = 0; i < list->size; i++) {
+        list->rolls[i] = list->items[i]->roll;
+        list->marks[i] = (uint8_t)list->items[i]->marks;
     }
+}
 
-    if (find_index_by_roll(list, s->roll) >= 0) {
-        return ERR_DUPLICATE;
+/* ---------- Roll Number Index ---------- */
+
+/* Fibonacci hashing spreads consecutive roll numbers (the common case) across the table */
+static size_t roll_hash(int roll, size_t capacity) {
+    return (size_t)(((uint32_t)roll * 2654435769u)) & (capacity - 1);
+}
+
+static int roll_in_direct_range(int roll) {
+    return roll >= MIN_ROLL && roll <= MAX_ROLL;
+}
+
+static ErrorCode hash_buckets_init(RollIndex *idx, size_t capacity) {
+    RollIndexEntry *buckets = malloc(capacity * sizeof(RollIndexEntry));
+
+    if (!buckets) {
+        return ERR_MEMORY;
     }
-    
-    ErrorCode err = ensure_capacity(list);
 
-    if (err != SUCCESS) {
-        return err;
+    for (size_t i = 0; i < capacity; i++) {
+        buckets[i].index = -1;
     }
 
-    list->items[list->size++] = s;
-    list->modified = 1;
+    free(idx->buckets);
+    idx->buckets = buckets;
+    idx->capacity = capacity;
     return SUCCESS;
 }
 
-/* This block does: it removes a student and shifts all the remaining students 
-   to fill the gap, so there are no empty spaces in the array */
-static ErrorCode remove_student_by_index(StudentList *list, size_t index) {
-    if (!list || index >= list->size) {
-        return ERR_INVALID_INPUT;
+/* Puts an entry into a table that is known to have room and not to contain the roll yet */
+static void hash_place(RollIndexEntry *buckets, size_t capacity, int roll, long index) {
+    size_t mask = capacity - 1;
+    size_t b = roll_hash(roll, capacity);
+
+    while (buckets[b].index >= 0) {
+        b = (b + 1) & mask;
     }
 
-    free_student(list->items[index]);
-    
-    memmove(&list->items[index], &list->items[index + 1],
-            (list->size - index - 1) * sizeof(Student*));
-    list->size--;
-    list->modified = 1;
-    
-    return SUCCESS;
+    buckets[b].roll = roll;
+    buckets[b].index = index;
 }
 
-/* This case was added here so that when modifying a student, we check if the new roll number 
-   doesn't conflict with existing students (except the one being modified) */
-static ErrorCode modify_student(
-    StudentList *list, 
-    size_t index,
-    int new_roll, 
-    const char *new_name, 
-    int new_marks) {
-        
-    if (!list || index >= list->size) {
-        return ERR_INVALID_INPUT;
-    }
+/* The index starts in direct mode: one int32_t slot per possible roll in MIN_ROLL..MAX_ROLL,
+   so a lookup is a single array load */
+static ErrorCode roll_index_init(RollIndex *idx) {
+    idx->mode = INDEX_DIRECT;
+    idx->buckets = NULL;
+    idx->capacity = 0;
+    idx->count = 0;
+    idx->direct = malloc((MAX_ROLL + 1) * sizeof(int32_t));
 
-    if (new_roll != list->items[index]->roll) {
-        long existing = find_index_by_roll(list, new_roll);
-        if (existing >= 0 && (size_t)existing != index) {
-            return ERR_DUPLICATE;
-        }
-    }
-    
-    Student *s = list->items[index];
-    s->roll = new_roll;
-    s->marks = new_marks;
-    
-    free(s->name);
-    s->name = safe_strdup(new_name ? new_name : "Unnamed");
-    if (!s->name) {
+    if (!idx->direct) {
         return ERR_MEMORY;
     }
 
-    list->modified = 1;  // Mark as modified
+    memset(idx->direct, 0xff, (MAX_ROLL + 1) * sizeof(int32_t));  // All slots -1
     return SUCCESS;
 }
 
-/* Display Functions */
+static void roll_index_free(RollIndex *idx) {
+    free(idx->direct);
+    free(idx->buckets);
+    idx->direct = NULL;
+    idx->buckets = NULL;
+    idx->capacity = 0;
+    idx->count = 0;
+}
 
-static void display_student(const Student *s) {
-    if (!s) {
-        return;
+static long roll_index_find(const RollIndex *idx, int roll) {
+    if (idx->mode == INDEX_DIRECT) {
+        return (idx->direct && roll_in_direct_range(roll)) ? idx->direct[roll] : -1;
     }
 
-    printf("Roll: %-5d Name: %-30s Marks: %3d [%s]\n",
-           s->roll, s->name ? s->name : "(no name)", s->marks,
-           (s->marks >= PASS_THRESHOLD) ? "PASS" : "FAIL");
-}
+    if (idx->capacity == 0) {
+        return -1;
+    }
 
-static void display_all_students(const StudentList *list) {
-    if (!list || list->size == 0) {
-        printf("\nNo students in the system.\n");
-        return;
-    }
-    
-    printf("\nStudent Records (Total: %zu)\n", list->size);
-    printf("----------------------------------------------------------------------------\n");
-    
-    for (size_t i = 0; i < list->size; i++) {
-        printf("[%zu] ", i + 1);
-        display_student(list->items[i]);
-    }
-    printf("------------------------------------------------------------------------------\n");
-}
+    size_t mask = idx->capacity - 1;
 
-static void display_statistics(const StudentList *list) {
-    if (!list || list->size == 0) {
-        printf("\nNo data available for statistics.\n");
-        return;
-    }
-    
-    int pass_count = 0, fail_count = 0;
-    int min_marks = 100, max_marks = 0;
-    long total_marks = 0;
-    
-    for (size_t i = 0; i < list->size; i++) {
-        int marks = list->items[i]->marks;
-        total_marks += marks;
-        
-        if (marks >= PASS_THRESHOLD) {
-            pass_count++;
-        }else {
-            fail_count++;
-        }
+    for (size_t b = roll_hash(roll, idx->capacity); ; b = (b + 1) & mask) {
+        const RollIndexEntry *e = &idx->buckets[b];
 
-        if (marks < min_marks) {
-            min_marks = marks;
+        if (e->index < 0) {
+            return -1;
         }
 
-        if (marks > max_marks) {
-            max_marks = marks;
+        if (e->roll == roll) {
+            return e->index;
         }
     }
-    
-    double avg = (double)total_marks / list->size;
-    double pass_rate = (double)pass_count / list->size * 100;
-    
-    printf("\nStatistics Summary\n");
-    printf("----------------------------------------------------------------------\n");
-    printf("Total Students:    %zu\n", list->size);
-    printf("Average Marks:     %.2f\n", avg);
-    printf("Highest Marks:     %d\n", max_marks);
-    printf("Lowest Marks:      %d\n", min_marks);
-    printf("Pass Count:        %d (%.1f%%)\n", pass_count, pass_rate);
-    printf("Fail Count:        %d\n", fail_count);
-    printf("----------------------------------------------------------------------\n");
 }
 
-/* ---------- File Operations section (this area deals with the operations for the file handling, creation and all) ---------- */
+/* This block does: it switches a direct table over to hashing the first time a roll
+   outside MIN_ROLL..MAX_ROLL shows up (files written by other tools can contain them) */
+static ErrorCode roll_index_to_hash(RollIndex *idx) {
+    size_t capacity = INITIAL_INDEX_CAPACITY;
 
-/* This part of the code does this: it saves all students to a text file using the format roll|marks|name
-   so the data can be stored permanently and loaded later */
-static ErrorCode save_to_file(StudentList *list, const char *filename) {
-    if (!list || !filename) {
-        return ERR_INVALID_INPUT;
-    }
-    
-    FILE *f = fopen(filename, "w");
-    
-    if (!f) {
-        fprintf(stderr, "Error: Cannot open '%s' for writing: %s\n",
-                filename, strerror(errno));
-        return ERR_FILE_IO;
-    }
-    
-    fprintf(f, "# Student Record System Data File\n");
-    fprintf(f, "# Format: roll|marks|name\n");
-    fprintf(f, "# Total records: %zu\n", list->size);
-    
-    for (size_t i = 0; i < list->size; i++) {
-        Student *s = list->items[i];
-        fprintf(f, "%d|%d|%s\n", s->roll, s->marks, s->name ? s->name : "");
+    while (capacity < (idx->count + 1) * 2) {
+        capacity *= 2;
     }
-    
-    fclose(f);
-    
-    // Update last filename and clear modified flag
-    char *new_filename = safe_strdup(filename);
-    if (!new_filename) {
+
+    if (hash_buckets_init(idx, capacity) != SUCCESS) {
         return ERR_MEMORY;
     }
-    free(list->last_filename);
-    list->last_filename = new_filename;
-    list->modified = 0;
+
+    for (int roll = MIN_ROLL; roll <= MAX_ROLL; roll++) {
+        if (idx->direct[roll] >= 0) {
+            hash_place(idx->buckets, idx->capacity, roll, idx->direct[roll]);
+        }
+    }
+
+    free(idx->direct);
+    idx->direct = NULL;
+    idx->mode = INDEX_HASH;
     return SUCCESS;
 }
 
-static ErrorCode load_from_file(StudentList *list, const char *filename) {
-    if (!list || !filename) {
-        return ERR_INVALID_INPUT;
+/* This block does: it doubles the table once it is half full, so probe chains stay short */
+static ErrorCode roll_index_grow(RollIndex *idx) {
+    size_t new_capacity = idx->capacity * 2;
+    RollIndexEntry *bigger = malloc(new_capacity * sizeof(RollIndexEntry));
+
+    if (!bigger) {
+        return ERR_MEMORY;
     }
-    
-    FILE *f = fopen(filename, "r");
-    if (!f) {
-        fprintf(stderr, "Error: Cannot open '%s' for reading: %s\n",
-                filename, strerror(errno));
-        return ERR_FILE_IO;
+
+    for (size_t i = 0; i < new_capacity; i++) {
+        bigger[i].index = -1;
     }
-    
-    // Clear existing list
-    for (size_t i = 0; i < list->size; i++) {
-        free_student(list->items[i]);
+
+    for (size_t i = 0; i < idx->capacity; i++) {
+        if (idx->buckets[i].index >= 0) {
+            hash_place(bigger, new_capacity, idx->buckets[i].roll, idx->buckets[i].index);
+        }
     }
-    list->size = 0;
-    
-    char buffer[MAX_LINE_LENGTH];
-    size_t line_num = 0;
-    size_t loaded = 0;
-    
-    while (fgets(buffer, sizeof(buffer), f)) {
-        line_num++;
-        
-        // Skip comments and empty lines
-        if (buffer[0] == '#' || buffer[0] == '\n') continue;
-        
-        // Remove newline
-        buffer[strcspn(buffer, "\n")] = '\0';
-        
-        // Parse: roll|marks|name
-        char *p1 = strchr(buffer, '|');
-        if (!p1) {
-            fprintf(stderr, "Warning: Invalid format at line %zu\n", line_num);
-            continue;
+
+    free(idx->buckets);
+    idx->buckets = bigger;
+    idx->capacity = new_capacity;
+    return SUCCESS;
+}
+
+static ErrorCode roll_index_insert(RollIndex *idx, int roll, long index) {
+    if (roll_index_find(idx, roll) >= 0) {
+        return ERR_DUPLICATE;
+    }
+
+    if (idx->mode == INDEX_DIRECT) {
+        if (roll_in_direct_range(roll)) {
+            idx->direct[roll] = (int32_t)index;
+            idx->count++;
+            return SUCCESS;
         }
-        *p1 = '\0';
-        
-        char *p2 = strchr(p1 + 1, '|');
-        if (!p2) {
-            fprintf(stderr, "Warning: Invalid format at line %zu\n", line_num);
-            continue;
+
+        ErrorCode err = roll_index_to_hash(idx);
+
+        if (err != SUCCESS) {
+            return err;
         }
-        *p2 = '\0';
-        
-        int roll = (int)strtol(buffer, NULL, 10);
-        int marks = (int)strtol(p1 + 1, NULL, 10);
-        char *name = p2 + 1;
-        trim_inplace(name);
-        
-        // Validate data
-        if (roll <= 0 || marks < 0 || marks > 100) {
-            fprintf(stderr, "Warning: Invalid data at line %zu (skipped)\n", line_num);
-            continue;
+    }
+
+    if ((idx->count + 1) * 2 > idx->capacity) {
+        ErrorCode err = roll_index_grow(idx);
+
+        if (err != SUCCESS) {
+            return err;
         }
-        
-        Student *s = create_student(roll, name, marks);
-        if (s && add_student(list, s) == SUCCESS) {
-            loaded++;
-        } else {
-            free_student(s);
-            fprintf(stderr, "Warning: Duplicate roll %d at line %zu (skipped)\n",
-                    roll, line_num);
+    }
+
+    hash_place(idx->buckets, idx->capacity, roll, index);
+    idx->count++;
+    return SUCCESS;
+}
+
+/* Updates the slot stored for a roll that is already in the index */
+static void roll_index_set(RollIndex *idx, int roll, long index) {
+    if (idx->mode == INDEX_DIRECT) {
+        if (roll_in_direct_range(roll)) {
+            idx->direct[roll] = (int32_t)index;
         }
+        return;
     }
-    
-    fclose(f);
-    
-    // Update last filename and clear modified flag
-    char *new_filename = safe_strdup(filename);
-    if (!new_filename) {
-        return ERR_MEMORY;
+
+    if (idx->capacity == 0) {
+        return;
+    }
+
+    size_t mask = idx->capacity - 1;
+
+    for (size_t b = roll_hash(roll, idx->capacity); idx->buckets[b].index >= 0; b = (b + 1) & mask) {
+        if (idx->buckets[b].roll == roll) {
+            idx->buckets[b].index = index;
+            return;
+        }
     }
-    free(list->last_filename);
-    list->last_filename = new_filename;
-    list->modified = 0;
-    
-    printf("Loaded %zu records from '%s'\n", loaded, filename);
-    return SUCCESS;
 }
 
-/* Reads and displays all student records directly from file without loading into memory */
-static ErrorCode display_from_file(const char *filename) {
-    if (!filename) {
-        return ERR_INVALID_INPUT;
+/* This part removes a roll using backward-shift deletion, so we never need tombstones
+   and lookups stay as fast after many deletes as they were before */
+static void roll_index_remove(RollIndex *idx, int roll) {
+    if (idx->mode == INDEX_DIRECT) {
+        if (roll_in_direct_range(roll) && idx->direct[roll] >= 0) {
+            idx->direct[roll] = -1;
+            idx->count--;
+        }
+        return;
     }
-    
-    FILE *f = fopen(filename, "r");
-    if (!f) {
-        fprintf(stderr, "Error: Cannot open '%s' for reading: %s\n",
-                filename, strerror(errno));
-        return ERR_FILE_IO;
+
+    if (idx->capacity == 0) {
+        return;
     }
-    
-    char buffer[MAX_LINE_LENGTH];
-    size_t line_num = 0;
-    size_t count = 0;
-    int roll, marks;
-    char name[MAX_NAME_LENGTH + 1];
-    
-    printf("\nReading from file: %s\n", filename);
-    printf("------------------------------------------------------------------------------\n");
-    while (fgets(buffer, sizeof(buffer), f)) {
-        line_num++;
-        
-        // Skip comments and empty lines
-        if (buffer[0] == '#' || buffer[0] == '\n') continue;
-        
-        // Remove newline
-        buffer[strcspn(buffer, "\n")] = '\0';
-        
-        // Parse: roll|marks|name
-        char *p1 = strchr(buffer, '|');
-        if (!p1) {
-            continue;
+
+    size_t mask = idx->capacity - 1;
+    size_t b = roll_hash(roll, idx->capacity);
+
+    while (idx->buckets[b].index >= 0 && idx->buckets[b].roll != roll) {
+        b = (b + 1) & mask;
+    }
+
+    if (idx->buckets[b].index < 0) {
+        return;
+    }
+
+    size_t hole = b;
+
+    for (size_t next = (hole + 1) & mask; idx->buckets[next].index >= 0; next = (next + 1) & mask) {
+        size_t home = roll_hash(idx->buckets[next].roll, idx->capacity);
+
+        // Move the entry back only if its home bucket is not between the hole and where it sits
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            idx->buckets[hole] = idx->buckets[next];
+            hole = next;
         }
-        *p1 = '\0';
-        
-        char *p2 = strchr(p1 + 1, '|');
-        if (!p2) {
-            continue;
+    }
+
+    idx->buckets[hole].index = -1;
+    idx->count--;
+}
+
+/* Rebuilds the whole index from items, used after the array order changes (e.g. sorting).
+   It goes back to direct mode whenever every roll fits the bounded range again */
+static ErrorCode roll_index_rebuild(StudentList *list) {
+    RollIndex *idx = &list->index;
+    int bounded = 1;
+
+    for (size_t i = 0; i < list->size; i++) {
+        if (!roll_in_direct_range(list->rolls[i])) {
+            bounded = 0;
+            break;
         }
-        *p2 = '\0';
-        
-        roll = (int)strtol(buffer, NULL, 10);
-        marks = (int)strtol(p1 + 1, NULL, 10);
-        char *name_ptr = p2 + 1;
-        trim_inplace(name_ptr);
-        
-        // Validate data
-        if (roll <= 0 || marks < 0 || marks > 100) {
-            continue;
+    }
+
+    if (bounded && !idx->direct) {
+        idx->direct = malloc((MAX_ROLL + 1) * sizeof(int32_t));
+        if (!idx->direct) {
+            bounded = 0;
         }
-        
-        // Copy name safely
-        strncpy(name, name_ptr, MAX_NAME_LENGTH);
-        name[MAX_NAME_LENGTH] = '\0';
-        
-        // Display the student
-        count++;
-        printf("[%zu] Roll: %-5d Name: %-30s Marks: %3d [%s]\n",
-               count, roll, name, marks,
-               (marks >= PASS_THRESHOLD) ? "PASS" : "FAIL");
     }
-    
-    fclose(f);
-    
-    if (count == 0) {
-        printf("No student records found in the file.\n");
+
+    if (bounded) {
+        free(idx->buckets);
+        idx->buckets = NULL;
+        idx->capacity = 0;
+        idx->mode = INDEX_DIRECT;
+        memset(idx->direct, 0xff, (MAX_ROLL + 1) * sizeof(int32_t));
     } else {
-        printf("----------------------------------------------------------------------------\n");
-        printf("Total records in file: %zu\n", count);
+        size_t capacity = INITIAL_INDEX_CAPACITY;
+
+        while (capacity < (list->size + 1) * 2) {
+            capacity *= 2;
+        }
+
+        if (hash_buckets_init(idx, capacity) != SUCCESS) {
+            return ERR_MEMORY;
+        }
+
+        free(idx->direct);
+        idx->direct = NULL;
+        idx->mode = INDEX_HASH;
     }
-    
+
+    idx->count = 0;
+
+    for (size_t i = 0; i < list->size; i++) {
+        ErrorCode err = roll_index_insert(idx, list->rolls[i], (long)i);
+
+        if (err != SUCCESS) {
+            return err;
+        }
+    }
+
     return SUCCESS;
 }
 
-/* Searches for a specific student by roll number directly in the file */
-static ErrorCode search_in_file(const char *filename, int roll) {
-    if (!filename) {
-        return ERR_INVALID_INPUT;
-    }
-    
-    FILE *f = fopen(filename, "r");
-    if (!f) {
-        fprintf(stderr, "Error: Cannot open '%s' for reading: %s\n",
-                filename, strerror(errno));
-        return ERR_FILE_IO;
+/* ---------- Sorted Views ---------- */
+
+/* by_name orders every student by name (under list->collation), then roll; by_marks orders
+   them by marks, then name, then roll. Both are built on first use and then kept current
+   by add, modify and remove, so a sorted display is a walk instead of a sort, and items
+   (the file's order) only changes when the user saves a sorted order */
+static int collate_compare(const char *a, const char *b, CollationMode mode) {
+    if (mode == COLLATE_LOCALE) {
+        return strcoll(a, b);
     }
-    
-    char buffer[MAX_LINE_LENGTH];
-    size_t line_num = 0;
-    int found = 0;
-    
-    printf("\nSearching for roll number %d in file: %s\n", roll, filename);
-    printf("---------------------------------------------------------------------------\n");
-    
-    while (fgets(buffer, sizeof(buffer), f)) {
-        line_num++;
-        
-        // Skip comments and empty lines
-        if (buffer[0] == '#' || buffer[0] == '\n') continue;
-        
-        // Remove newline
-        buffer[strcspn(buffer, "\n")] = '\0';
-        
-        // Parse: roll|marks|name
-        char *p1 = strchr(buffer, '|');
-        if (!p1) continue;
-        *p1 = '\0';
-        
-        char *p2 = strchr(p1 + 1, '|');
-        if (!p2) continue;
-        *p2 = '\0';
-        
-        int file_roll = (int)strtol(buffer, NULL, 10);
-        
-        // This Checks if this is the student we're looking for
-        if (file_roll == roll) {
-            int marks = (int)strtol(p1 + 1, NULL, 10);
-            char *name = p2 + 1;
-            trim_inplace(name);
-            
-            // Validate and display
-            if (roll > 0 && marks >= 0 && marks <= 100) {
-                found = 1;
-                printf("Found at line %zu:\n", line_num);
-                printf("Roll: %-5d Name: %-30s Marks: %3d [%s]\n",
-                       file_roll, name, marks,
-                       (marks >= PASS_THRESHOLD) ? "PASS" : "FAIL");
-                break;
-            }
+
+    if (mode == COLLATE_NOCASE) {
+        const unsigned char *pa = (const unsigned char *)a;
+        const unsigned char *pb = (const unsigned char *)b;
+
+        while (*pa && tolower(*pa) == tolower(*pb)) {
+            pa++;
+            pb++;
         }
+
+        return tolower(*pa) - tolower(*pb);
     }
-    
-    fclose(f);
-    
-    if (!found) {
-        printf("Student with roll number %d not found in the file.\n", roll);
-    }
-    printf("-------------------------------------------------------------------------------\n");
-    
-    return found ? SUCCESS : ERR_NOT_FOUND;
+
+    return strcmp(a, b);
 }
 
-/* Calculates statistics by reading all records from file and aggregating data */
-static ErrorCode statistics_from_file(const char *filename) {
-    if (!filename) {
-        return ERR_INVALID_INPUT;
+static int view_compare(const StudentList *list, int by_marks, const Student *a, const Student *b) {
+    if (by_marks && a->marks != b->marks) {
+        return a->marks - b->marks;
     }
-    
-    FILE *f = fopen(filename, "r");
-    if (!f) {
-        fprintf(stderr, "Error: Cannot open '%s' for reading: %s\n",
-                filename, strerror(errno));
-        return ERR_FILE_IO;
+
+    int c = collate_compare(a->name, b->name, list->collation);
+    if (c != 0) {
+        return c;
+    }
+
+    return (a->roll > b->roll) - (a->roll < b->roll);
+}
+
+/* First position in the view whose student does not sort before s. Rolls are unique, so
+   for a student already in the view this is exactly its slot */
+static size_t view_lower_bound(const StudentList *list, Student **view, int by_marks,
+                               size_t count, const Student *s) {
+    size_t lo = 0, hi = count;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+
+        if (view_compare(list, by_marks, view[mid], s) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+static void view_insert(const StudentList *list, Student **view, int by_marks,
+                        size_t count, Student *s) {
+    size_t pos = view_lower_bound(list, view, by_marks, count, s);
+    memmove(&view[pos + 1], &view[pos], (count - pos) * sizeof(Student*));
+    view[pos] = s;
+}
+
+static void view_remove(const StudentList *list, Student **view, int by_marks,
+                        size_t count, const Student *s) {
+    size_t pos = view_lower_bound(list, view, by_marks, count, s);
+
+    if (pos < count && view[pos] == s) {
+        memmove(&view[pos], &view[pos + 1], (count - pos - 1) * sizeof(Student*));
+    }
+}
+
+/* count is how many students the views hold before the call */
+static void views_add(StudentList *list, Student *s, size_t count) {
+    if (list->views_valid) {
+        view_insert(list, list->by_name, 0, count, s);
+        view_insert(list, list->by_marks, 1, count, s);
+    }
+}
+
+/* Must run while s still holds the roll, name and marks it was placed under */
+static void views_drop(StudentList *list, const Student *s, size_t count) {
+    if (list->views_valid) {
+        view_remove(list, list->by_name, 0, count, s);
+        view_remove(list, list->by_marks, 1, count, s);
+    }
+}
+
+static void views_invalidate(StudentList *list) {
+    list->views_valid = 0;
+}
+
+/* Builds both views from items: a radix sort on collation keys for by_name, then a
+   stable counting sort of by_name on marks for by_marks */
+static ErrorCode views_build(StudentList *list) {
+    if (list->views_valid) {
+        return SUCCESS;
+    }
+
+    if (!list->by_name) {
+        list->by_name = malloc(list->capacity * sizeof(Student*));
+        list->by_marks = malloc(list->capacity * sizeof(Student*));
+
+        if (!list->by_name || !list->by_marks) {
+            free(list->by_name);
+            free(list->by_marks);
+            list->by_name = NULL;
+            list->by_marks = NULL;
+            return ERR_MEMORY;
+        }
+    }
+
+    memcpy(list->by_name, list->items, list->size * sizeof(Student*));
+
+    ErrorCode err = sort_by_name_keys(list->by_name, list->size, list->collation);
+    if (err != SUCCESS) {
+        return err;
+    }
+
+    counting_sort_by_marks(list->by_name, list->by_marks, list->size);
+    list->views_valid = 1;
+    return SUCCESS;
+}
+
+/* Calls visit for every student in view order. Marks descending walks by_marks one mark
+   group at a time from the top, keeping name order inside each group */
+static void view_walk(const StudentList *list, StudentView view,
+                      void (*visit)(Student *s, size_t pos, void *ctx), void *ctx) {
+    if (view == VIEW_NAME || view == VIEW_MARKS_ASC) {
+        Student **order = (view == VIEW_NAME) ? list->by_name : list->by_marks;
+
+        for (size_t i = 0; i < list->size; i++) {
+            visit(order[i], i, ctx);
+        }
+        return;
+    }
+
+    size_t end = list->size;
+    size_t pos = 0;
+
+    for (int m = MAX_MARKS; m >= 0; m--) {
+        size_t start = end - list->marks_hist[m];
+
+        for (size_t i = start; i < end; i++) {
+            visit(list->by_marks[i], pos++, ctx);
+        }
+        end = start;
+    }
+}
+
+static void view_store(Student *s, size_t pos, void *ctx) {
+    ((Student **)ctx)[pos] = s;
+}
+
+/* The student at position i of a view, for jumping straight to a page */
+static Student *view_at(const StudentList *list, StudentView view, size_t i) {
+    if (view == VIEW_NAME) {
+        return list->by_name[i];
+    }
+    if (view == VIEW_MARKS_ASC) {
+        return list->by_marks[i];
+    }
+
+    size_t end = list->size;
+
+    for (int m = MAX_MARKS; m >= 0; m--) {
+        size_t group = list->marks_hist[m];
+        size_t start = end - group;
+
+        if (i < group) {
+            return list->by_marks[start + i];
+        }
+        i -= group;
+        end = start;
+    }
+
+    return NULL;
+}
+
+/* ---------- Student Operations ---------- */
+
+/* Students are allocated from the list's arena; a record that never gets added
+   must be returned with free_student on the same list */
+static Student *create_student(StudentList *list, int roll, const char *name, int marks) {
+    Student *student;
+
+    if (list->arena.free_students) {
+        student = (Student *)list->arena.free_students;
+        list->arena.free_students = list->arena.free_students->next;
+    } else {
+        student = arena_alloc(&list->arena, sizeof(Student));
+        if (!student) {
+            return NULL;
+        }
     }
     
-    char buffer[MAX_LINE_LENGTH];
-    size_t line_num = 0;
-    size_t count = 0;
-    int pass_count = 0, fail_count = 0;
-    int min_marks = 100, max_marks = 0;
-    long total_marks = 0;
-    
-    printf("\nCalculating statistics from file: %s\n", filename);
+    student->roll = roll;
+    student->name = arena_alloc_name(&list->arena, name ? name : "Unnamed");
+    student->marks = marks;
+    student->row = -1;
+    student->dirty = 1;
+
+    if (!student->name) {
+        free_student(list, student);
+        return NULL;
+    }
+
+    return student;
+}
+
+static long find_index_by_roll(const StudentList *list, int roll) {
+    if (!list) {
+        return -1;
+    }
+
+    return roll_index_find(&list->index, roll);
+}
+
+/* This part checks for duplicates before adding, so we don't have two students with the same roll number */
+static ErrorCode add_student(StudentList *list, Student *s) {
+    if (!list || !s) {
+        return ERR_INVALID_INPUT;
+    }
+
+    if (find_index_by_roll(list, s->roll) >= 0) {
+        return ERR_DUPLICATE;
+    }
     
-    while (fgets(buffer, sizeof(buffer), f)) {
-        line_num++;
-        
-        // Skip comments and empty lines
-        if (buffer[0] == '#' || buffer[0] == '\n') continue;
-        
-        // Remove newline
-        buffer[strcspn(buffer, "\n")] = '\0';
-        
-        // Parse: roll|marks|name
-        char *p1 = strchr(buffer, '|');
-        if (!p1) continue;
-        *p1 = '\0';
-        
-        char *p2 = strchr(p1 + 1, '|');
-        if (!p2) continue;
-        *p2 = '\0';
-        
-        int roll = (int)strtol(buffer, NULL, 10);
-        int marks = (int)strtol(p1 + 1, NULL, 10);
+    ErrorCode err = ensure_capacity(list);
+
+    if (err != SUCCESS) {
+        return err;
+    }
+
+    err = roll_index_insert(&list->index, s->roll, (long)list->size);
+
+    if (err != SUCCESS) {
+        return err;
+    }
+
+    views_add(list, s, list->size);
+    list->items[list->size] = s;
+    list->rolls[list->size] = s->roll;
+    list->marks[list->size] = (uint8_t)s->marks;
+    list->size++;
+    stats_add(list, s->marks);
+    list->modified = 1;
+    return SUCCESS;
+}
+
+/* This block does: it removes a student and shifts all the remaining students 
+   to fill the gap, so there are no empty spaces in the array */
+static ErrorCode remove_student_by_index(StudentList *list, size_t index) {
+    if (!list || index >= list->size) {
+        return ERR_INVALID_INPUT;
+    }
+
+    roll_index_remove(&list->index, list->items[index]->roll);
+    stats_remove(list, list->items[index]->marks);
+    views_drop(list, list->items[index], list->size);
+    store_forget(list, list->items[index]);
+    free_student(list, list->items[index]);
+    
+    size_t tail = list->size - index - 1;
+    memmove(&list->items[index], &list->items[index + 1], tail * sizeof(Student*));
+    memmove(&list->rolls[index], &list->rolls[index + 1], tail * sizeof(int32_t));
+    memmove(&list->marks[index], &list->marks[index + 1], tail * sizeof(uint8_t));
+    list->size--;
+
+    // Everyone after the gap moved down one slot, so their index entries follow
+    for (size_t i = index; i < list->size; i++) {
+        roll_index_set(&list->index, list->rolls[i], (long)i);
+    }
+
+    list->modified = 1;
+    
+    return SUCCESS;
+}
+
+/* This case was added here so that when modifying a student, we check if the new roll number 
+   doesn't conflict with existing students (except the one being modified) */
+static ErrorCode modify_student(
+    StudentList *list, 
+    size_t index,
+    int new_roll, 
+    const char *new_name, 
+    int new_marks) {
         
-        // Validate data
-        if (roll <= 0 || marks < 0 || marks > 100) {
+    if (!list || index >= list->size) {
+        return ERR_INVALID_INPUT;
+    }
+
+    if (new_roll != list->items[index]->roll) {
+        long existing = find_index_by_roll(list, new_roll);
+        if (existing >= 0 && (size_t)existing != index) {
+            return ERR_DUPLICATE;
+        }
+    }
+    
+    Student *s = list->items[index];
+    if (!new_name) {
+        new_name = "Unnamed";
+    }
+
+    // A rename within the same size class is written over the old buffer
+    char *name_copy = NULL;
+    if (name_class(strlen(new_name) + 1) != name_class(strlen(s->name) + 1)) {
+        name_copy = arena_alloc_name(&list->arena, new_name);
+        if (!name_copy) {
+            return ERR_MEMORY;
+        }
+    }
+
+    if (new_roll != s->roll) {
+        roll_index_remove(&list->index, s->roll);
+
+        ErrorCode err = roll_index_insert(&list->index, new_roll, (long)index);
+        if (err != SUCCESS) {
+            roll_index_insert(&list->index, s->roll, (long)index);
+            arena_free_name(&list->arena, name_copy);
+            return err;
+        }
+    }
+
+    store_touch(list, s);
+
+    // Out of the views under the old fields, back in under the new ones
+    views_drop(list, s, list->size);
+    stats_remove(list, s->marks);
+    stats_add(list, new_marks);
+    s->roll = new_roll;
+    s->marks = new_marks;
+    list->rolls[index] = new_roll;
+    list->marks[index] = (uint8_t)new_marks;
+    
+    if (name_copy) {
+        arena_free_name(&list->arena, s->name);
+        s->name = name_copy;
+    } else if (s->name != new_name) {
+        memmove(s->name, new_name, strlen(new_name) + 1);
+    }
+
+    views_add(list, s, list->size - 1);
+
+    list->modified = 1;  // Mark as modified
+    return SUCCESS;
+}
+
+/* ---------- Buffered Output ---------- */
+
+/* Table dumps format their rows into one large buffer by hand and hand it to write() when
+   it fills, instead of one locked, format-parsing printf per field. stdout is flushed
+   first so the rows land after anything already printed */
+static ErrorCode output_open(OutputBuffer *out, int fd) {
+    fflush(stdout);
+    out->data = malloc(OUTPUT_BUFFER_SIZE);
+    out->len = 0;
+    out->fd = fd;
+    out->failed = 0;
+    return out->data ? SUCCESS : ERR_MEMORY;
+}
+
+static void output_flush(OutputBuffer *out) {
+    size_t done = 0;
+
+    while (done < out->len && !out->failed) {
+        ssize_t n = write(out->fd, out->data + done, out->len - done);
+
+        if (n < 0 && errno == EINTR) {
             continue;
         }
-        
-        count++;
-        total_marks += marks;
-        
-        if (marks >= PASS_THRESHOLD) {
-            pass_count++;
+        if (n <= 0) {
+            out->failed = 1;  // Nothing more can be shown; the rest is dropped
+            break;
+        }
+        done += (size_t)n;
+    }
+
+    out->len = 0;
+}
+
+static void output_close(OutputBuffer *out) {
+    output_flush(out);
+    free(out->data);
+    out->data = NULL;
+}
+
+static void output_bytes(OutputBuffer *out, const char *s, size_t n) {
+    while (n > 0) {
+        if (out->len == OUTPUT_BUFFER_SIZE) {
+            output_flush(out);
+        }
+
+        size_t room = OUTPUT_BUFFER_SIZE - out->len;
+        size_t chunk = n < room ? n : room;
+
+        memcpy(out->data + out->len, s, chunk);
+        out->len += chunk;
+        s += chunk;
+        n -= chunk;
+    }
+}
+
+static void output_str(OutputBuffer *out, const char *s) {
+    output_bytes(out, s, strlen(s));
+}
+
+static void output_spaces(OutputBuffer *out, size_t n) {
+    static const char spaces[] = "                                ";
+
+    while (n > 0) {
+        size_t chunk = n < sizeof(spaces) - 1 ? n : sizeof(spaces) - 1;
+        output_bytes(out, spaces, chunk);
+        n -= chunk;
+    }
+}
+
+/* Same as printf's %d with a width (%-5d when left_align is set, %3d otherwise) */
+static void output_int(OutputBuffer *out, long long value, int width, int left_align) {
+    char digits[24];
+    int n = 0;
+    unsigned long long v = (value < 0) ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+
+    do {
+        digits[sizeof(digits) - 1 - n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v > 0);
+
+    if (value < 0) {
+        digits[sizeof(digits) - 1 - n++] = '-';
+    }
+
+    size_t pad = (width > n) ? (size_t)(width - n) : 0;
+
+    if (!left_align) {
+        output_spaces(out, pad);
+    }
+    output_bytes(out, digits + sizeof(digits) - n, (size_t)n);
+    if (left_align) {
+        output_spaces(out, pad);
+    }
+}
+
+/* "[pos] Roll: %-5d Name: %-30s Marks: %3d [PASS]" without printf */
+static void output_student_row(OutputBuffer *out, size_t pos, int roll,
+                               const char *name, size_t name_len, int marks) {
+    output_bytes(out, "[", 1);
+    output_int(out, (long long)pos, 0, 0);
+    output_bytes(out, "] Roll: ", 8);
+    output_int(out, roll, 5, 1);
+    output_bytes(out, " Name: ", 7);
+    output_bytes(out, name, name_len);
+    output_spaces(out, name_len < 30 ? 30 - name_len : 0);
+    output_bytes(out, " Marks: ", 8);
+    output_int(out, marks, 3, 0);
+    output_str(out, (marks >= PASS_THRESHOLD) ? " [PASS]\n" : " [FAIL]\n");
+}
+
+/* ---------- Pager ---------- */
+
+/* Big tables are shown a page at a time when a person is at the terminal; piped or
+   scripted runs still get the whole table in one go */
+static int pager_enabled(void) {
+    return isatty(STDIN_FILENO) && isatty(STDOUT_FILENO);
+}
+
+/* Shows total records through render, one page at a time. Only the rows on screen are
+   ever formatted; render is asked for records [first, first + count) */
+static ErrorCode run_pager(size_t total, PageRenderer render, void *ctx) {
+    size_t page_size = PAGE_SIZE;
+    size_t page = 0;
+
+    while (total > 0) {
+        size_t pages = (total + page_size - 1) / page_size;
+        if (page >= pages) {
+            page = pages - 1;
+        }
+
+        size_t first = page * page_size;
+        size_t count = (total - first < page_size) ? total - first : page_size;
+        OutputBuffer out;
+
+        if (output_open(&out, STDOUT_FILENO) != SUCCESS) {
+            return ERR_MEMORY;
+        }
+        render(ctx, first, count, &out);
+        output_close(&out);
+
+        printf("Page %zu of %zu (records %zu-%zu of %zu)\n",
+               page + 1, pages, first + 1, first + count, total);
+
+        char *cmd = read_line("[n]ext, [p]revious, [g]o to page, page [s]ize, [q]uit: ");
+        if (!cmd) {
+            break;
+        }
+
+        trim_inplace(cmd);
+        char c = (char)tolower((unsigned char)cmd[0]);
+        free(cmd);
+
+        if (c == 'q' || (c == '\0' && page + 1 == pages)) {
+            break;
+        } else if (c == 'n' || c == '\0') {
+            if (page + 1 < pages) {
+                page++;
+            } else {
+                printf("Already on the last page.\n");
+            }
+        } else if (c == 'p') {
+            if (page > 0) {
+                page--;
+            } else {
+                printf("Already on the first page.\n");
+            }
+        } else if (c == 'g') {
+            int max_page = pages > INT_MAX ? INT_MAX : (int)pages;
+            page = (size_t)prompt_int("Go to page: ", 1, max_page) - 1;
+        } else if (c == 's') {
+            page_size = (size_t)prompt_int("Records per page: ", 1, MAX_PAGE_SIZE);
+            page = first / page_size;  // Keep the current first record on screen
         } else {
-            fail_count++;
+            printf("Unknown command.\n");
+        }
+    }
+
+    return SUCCESS;
+}
+
+/* Offsets of every record in a file (byte offsets for text, row numbers for binary), so
+   a page can start reading at its first record instead of parsing everything before it */
+static ErrorCode record_index_add(RecordIndex *idx, uint64_t pos) {
+    if (idx->count == idx->capacity) {
+        size_t capacity = idx->capacity ? idx->capacity * 2 : INITIAL_INDEX_CAPACITY;
+        uint64_t *grown = realloc(idx->positions, capacity * sizeof(uint64_t));
+
+        if (!grown) {
+            return ERR_MEMORY;
+        }
+        idx->positions = grown;
+        idx->capacity = capacity;
+    }
+
+    idx->positions[idx->count++] = pos;
+    return SUCCESS;
+}
+
+static void record_index_free(RecordIndex *idx) {
+    free(idx->positions);
+    idx->positions = NULL;
+    idx->count = 0;
+    idx->capacity = 0;
+}
+
+/* Display Functions */
+
+static void display_student(const Student *s) {
+    if (!s) {
+        return;
+    }
+
+    printf("Roll: %-5d Name: %-30s Marks: %3d [%s]\n",
+           s->roll, s->name ? s->name : "(no name)", s->marks,
+           (s->marks >= PASS_THRESHOLD) ? "PASS" : "FAIL");
+}
+
+static void display_numbered(Student *s, size_t pos, void *ctx) {
+    const char *name = s->name ? s->name : "(no name)";
+    output_student_row(ctx, pos + 1, s->roll, name, strlen(name), s->marks);
+}
+
+static void render_view_page(void *ctx, size_t first, size_t count, OutputBuffer *out) {
+    const ViewPage *vp = ctx;
+
+    for (size_t i = first; i < first + count; i++) {
+        display_numbered(view_at(vp->list, vp->view, i), i, out);
+    }
+}
+
+/* Walks one of the sorted views, so showing a sorted list neither sorts nor touches items */
+static ErrorCode display_all_students(StudentList *list, StudentView view) {
+    if (!list || list->size == 0) {
+        printf("\nNo students in the system.\n");
+        return SUCCESS;
+    }
+
+    OutputBuffer out;
+    ErrorCode err = views_build(list);
+    if (err != SUCCESS) {
+        return err;
+    }
+    
+    printf("\nStudent Records (Total: %zu)\n", list->size);
+    printf("----------------------------------------------------------------------------\n");
+
+    if (pager_enabled() && list->size > PAGE_SIZE) {
+        ViewPage vp = { list, view };
+        err = run_pager(list->size, render_view_page, &vp);
+        printf("------------------------------------------------------------------------------\n");
+        return err;
+    }
+
+    if (output_open(&out, STDOUT_FILENO) != SUCCESS) {
+        return ERR_MEMORY;
+    }
+    view_walk(list, view, display_numbered, &out);
+    output_close(&out);
+
+    printf("------------------------------------------------------------------------------\n");
+
+    return SUCCESS;
+}
+
+/* Reads the running aggregate instead of rescanning the list; min and max come from the
+   marks histogram so they stay correct after removals */
+static void display_statistics(const StudentList *list, FILE *out) {
+    if (!list || list->size == 0) {
+        fprintf(out, "\nNo data available for statistics.\n");
+        return;
+    }
+    
+    int min_marks = 0, max_marks = MAX_MARKS;
+    size_t pass_count = list->pass_count;
+    size_t fail_count = list->size - pass_count;
+    long total_marks = list->marks_total;
+
+    while (min_marks < MAX_MARKS && list->marks_hist[min_marks] == 0) {
+        min_marks++;
+    }
+
+    while (max_marks > 0 && list->marks_hist[max_marks] == 0) {
+        max_marks--;
+    }
+    
+    double avg = (double)total_marks / list->size;
+    double pass_rate = (double)pass_count / list->size * 100;
+    
+    fprintf(out, "\nStatistics Summary\n");
+    fprintf(out, "----------------------------------------------------------------------\n");
+    fprintf(out, "Total Students:    %zu\n", list->size);
+    fprintf(out, "Average Marks:     %.2f\n", avg);
+    fprintf(out, "Highest Marks:     %d\n", max_marks);
+    fprintf(out, "Lowest Marks:      %d\n", min_marks);
+    fprintf(out, "Pass Count:        %zu (%.1f%%)\n", pass_count, pass_rate);
+    fprintf(out, "Fail Count:        %zu\n", fail_count);
+    fprintf(out, "----------------------------------------------------------------------\n");
+}
+
+/* ---------- File Operations section (this area deals with the operations for the file handling, creation and all) ---------- */
+
+static void file_stamp_from_stat(const struct stat *st, FileStamp *out) {
+    out->valid = 1;
+    out->dev = st->st_dev;
+    out->ino = st->st_ino;
+    out->size = st->st_size;
+    out->mtime_sec = st->st_mtim.tv_sec;
+    out->mtime_nsec = st->st_mtim.tv_nsec;
+}
+
+static ErrorCode file_stamp_read(const char *filename, FileStamp *out) {
+    struct stat st;
+
+    if (stat(filename, &st) != 0) {
+        out->valid = 0;
+        return ERR_FILE_IO;
+    }
+
+    file_stamp_from_stat(&st, out);
+    return SUCCESS;
+}
+
+static int file_stamp_equal(const FileStamp *a, const FileStamp *b) {
+    return a->valid && b->valid &&
+           a->dev == b->dev && a->ino == b->ino && a->size == b->size &&
+           a->mtime_sec == b->mtime_sec && a->mtime_nsec == b->mtime_nsec;
+}
+
+/* The in-memory list matches the file when it was last loaded from or saved to it,
+   nothing has changed in memory since, and the file (and its journal) still have the
+   same identity, size and modification time */
+static int list_in_sync(const StudentList *list, const char *filename) {
+    FileStamp current, journal;
+
+    if (list->modified || !list->last_filename || strcmp(list->last_filename, filename) != 0 ||
+        file_stamp_read(filename, &current) != SUCCESS ||
+        !file_stamp_equal(&list->file_stamp, &current)) {
+        return 0;
+    }
+
+    journal_stamp_read(filename, &journal);
+    return journal_stamp_matches(&list->journal_stamp, &journal);
+}
+
+/* This part is the cache-coherence check: it reloads only when the file has actually
+   changed under us (or memory holds changes that were never saved), so most menu
+   actions run on the in-memory list without parsing the file again */
+static ErrorCode sync_with_file(StudentList *list, const char *filename) {
+    // While our own background save is in flight the list is newer than the file
+    if (async_save_settle(list, 0)) {
+        return SUCCESS;
+    }
+
+    if (list_in_sync(list, filename)) {
+        return SUCCESS;
+    }
+
+    FileStamp current;
+    if (file_stamp_read(filename, &current) != SUCCESS) {
+        return ERR_FILE_IO;
+    }
+
+    return load_from_file(list, filename);
+}
+
+/* Folds any pending journal entries into the data file, so the readers that go straight
+   to the file (display, search, statistics) see them */
+static ErrorCode compact_journal(StudentList *list, const char *filename) {
+    async_save_settle(list, 1);
+
+    FileStamp journal;
+    journal_stamp_read(filename, &journal);
+
+    if (!journal.valid) {
+        return SUCCESS;
+    }
+
+    ErrorCode err = sync_with_file(list, filename);
+    if (err != SUCCESS) {
+        return err;
+    }
+
+    return save_to_file(list, filename);
+}
+
+/* Builds the name of a file kept next to the data file, e.g. "students.txt" + ".log" */
+static char *sidecar_path(const char *filename, const char *suffix) {
+    size_t len = strlen(filename);
+    size_t suffix_len = strlen(suffix);
+    char *path = malloc(len + suffix_len + 1);
+
+    if (path) {
+        memcpy(path, filename, len);
+        memcpy(path + len, suffix, suffix_len + 1);
+    }
+
+    return path;
+}
+
+/* This was added so that passing list->last_filename itself (as the menu does) doesn't
+   free the string the caller is still holding */
+static ErrorCode remember_filename(StudentList *list, const char *filename) {
+    if (list->last_filename == filename ||
+        (list->last_filename && strcmp(list->last_filename, filename) == 0)) {
+        return SUCCESS;
+    }
+
+    char *new_filename = safe_strdup(filename);
+    if (!new_filename) {
+        return ERR_MEMORY;
+    }
+    free(list->last_filename);
+    list->last_filename = new_filename;
+    return SUCCESS;
+}
+
+/* ---------- Text Record Parser ---------- */
+
+/* Returns the first c in [p, end), or NULL. With SSE2/AVX2 it compares 16/32 bytes per step
+   and uses the match bitmask to jump straight to the hit; the scalar loop covers the tail
+   and builds without those instruction sets */
+static const char *find_byte(const char *p, const char *end, char c) {
+#if defined(__AVX2__)
+    const __m256i needle32 = _mm256_set1_epi8(c);
+
+    while (end - p >= 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)(const void *)p);
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle32));
+
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i needle16 = _mm_set1_epi8(c);
+
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(const void *)p);
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle16));
+
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+#endif
+    while (p < end) {
+        if (*p == c) {
+            return p;
+        }
+        p++;
+    }
+
+    return NULL;
+}
+
+/* Reads [start, end) of a file in SCAN_BUFFER_SIZE blocks with pread, so the same scanner
+   serves whole files and byte ranges */
+static ErrorCode line_scanner_open(LineScanner *sc, int fd, off_t start, off_t end) {
+    sc->buf = malloc(SCAN_BUFFER_SIZE + 1);
+
+    if (!sc->buf) {
+        return ERR_MEMORY;
+    }
+
+    sc->cap = SCAN_BUFFER_SIZE;
+    sc->fd = fd;
+    sc->len = 0;
+    sc->pos = 0;
+    sc->buf_offset = start;
+    sc->read_offset = start;
+    sc->end = end;
+    sc->line_num = 0;
+    return SUCCESS;
+}
+
+static void line_scanner_close(LineScanner *sc) {
+    free(sc->buf);
+    sc->buf = NULL;
+}
+
+/* Moves the unread tail to the front of the buffer and tops it up from the file */
+static int line_scanner_fill(LineScanner *sc) {
+    size_t rest = sc->len - sc->pos;
+
+    if (sc->pos > 0) {
+        memmove(sc->buf, sc->buf + sc->pos, rest);
+        sc->buf_offset += (off_t)sc->pos;
+        sc->pos = 0;
+        sc->len = rest;
+    }
+
+    size_t room = sc->cap - sc->len;
+    if (sc->end >= 0 && (off_t)room > sc->end - sc->read_offset) {
+        room = (size_t)(sc->end - sc->read_offset);
+    }
+
+    if (room == 0) {
+        return 0;
+    }
+
+    ssize_t n;
+    do {
+        n = pread(sc->fd, sc->buf + sc->len, room, sc->read_offset);
+    } while (n < 0 && errno == EINTR);
+
+    if (n <= 0) {
+        return 0;
+    }
+
+    sc->len += (size_t)n;
+    sc->read_offset += n;
+    return 1;
+}
+
+/* Doubles the buffer once a single line fills it, so the line still comes out whole */
+static int line_scanner_grow(LineScanner *sc) {
+    if (sc->cap > (SIZE_MAX - 1) / 2) {
+        return 0;
+    }
+
+    char *buf = realloc(sc->buf, sc->cap * 2 + 1);
+    if (!buf) {
+        return 0;
+    }
+
+    sc->buf = buf;
+    sc->cap *= 2;
+    return 1;
+}
+
+/* Hands out the next line (without its newline, NUL-terminated in place) and the file
+   offset it starts at. Returns 0 when the range is exhausted */
+static int line_scanner_next(LineScanner *sc, char **line, size_t *len, off_t *offset) {
+    if (sc->pos == sc->len && !line_scanner_fill(sc)) {
+        return 0;
+    }
+
+    const char *nl = find_byte(sc->buf + sc->pos, sc->buf + sc->len, '\n');
+
+    while (!nl) {
+        size_t scanned = sc->len - sc->pos;
+
+        if (scanned == sc->cap && !line_scanner_grow(sc)) {
+            // No memory for the whole line. Its first part could still parse as a record,
+            // so the line is skipped and handed out as one that fails to parse
+            *offset = sc->buf_offset;
+            do {
+                sc->pos = sc->len;
+                if (!line_scanner_fill(sc)) {
+                    break;
+                }
+                nl = find_byte(sc->buf, sc->buf + sc->len, '\n');
+            } while (!nl);
+
+            sc->pos = nl ? (size_t)(nl - sc->buf) + 1 : sc->len;
+            strcpy(sc->skipped, "(line too long)");
+            *line = sc->skipped;
+            *len = strlen(sc->skipped);
+            sc->line_num++;
+            return 1;
+        }
+        if (!line_scanner_fill(sc)) {
+            break;
+        }
+        nl = find_byte(sc->buf + sc->pos + scanned, sc->buf + sc->len, '\n');
+    }
+
+    size_t line_end = nl ? (size_t)(nl - sc->buf) : sc->len;
+
+    *line = sc->buf + sc->pos;
+    *len = line_end - sc->pos;
+    *offset = sc->buf_offset + (off_t)sc->pos;
+    sc->buf[line_end] = '\0';
+    sc->pos = nl ? line_end + 1 : line_end;
+    sc->line_num++;
+    return 1;
+}
+
+/* Decodes a small decimal field the way strtol would (leading blanks, optional sign, digits
+   up to the first non-digit) without strtol's locale and errno handling. Values that don't
+   fit in an int come back as -1 so validation rejects them */
+static int decode_int(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+
+    int negative = 0;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+
+    long value = 0;
+    while (p < end && (unsigned)(*p - '0') < 10) {
+        value = value * 10 + (*p - '0');
+        if (value > INT_MAX) {
+            return -1;
+        }
+        p++;
+    }
+
+    return negative ? -(int)value : (int)value;
+}
+
+/* Splits one roll|marks|name line. The name is trimmed in place; comment and blank lines
+   are reported as PARSE_SKIP */
+static ParseResult parse_record_line(char *line, size_t len, ParsedRecord *rec) {
+    if (len == 0 || line[0] == '#') {
+        return PARSE_SKIP;
+    }
+
+    char *end = line + len;
+    char *p1 = (char *)find_byte(line, end, '|');
+    if (!p1) {
+        return PARSE_BAD_FORMAT;
+    }
+
+    char *p2 = (char *)find_byte(p1 + 1, end, '|');
+    if (!p2) {
+        return PARSE_BAD_FORMAT;
+    }
+
+    rec->roll = decode_int(line, p1);
+    rec->marks = decode_int(p1 + 1, p2);
+
+    char *name = p2 + 1;
+    while (name < end && isspace((unsigned char)*name)) {
+        name++;
+    }
+    while (end > name && isspace((unsigned char)end[-1])) {
+        end--;
+    }
+    *end = '\0';
+    rec->name = name;
+    rec->name_len = (size_t)(end - name);
+
+    if (rec->roll <= 0 || rec->marks < 0 || rec->marks > MAX_MARKS) {
+        return PARSE_BAD_DATA;
+    }
+
+    return PARSE_RECORD;
+}
+
+/* Opens a data file for the readers below, reporting failures the way fopen callers did */
+static int open_for_reading(const char *filename) {
+    int fd = open(filename, O_RDONLY);
+
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot open '%s' for reading: %s\n",
+                filename, strerror(errno));
+    }
+
+    return fd;
+}
+
+/* ---------- Atomic File Replacement ---------- */
+
+/* Files are never rewritten in place: the new contents go to a temporary file next to the
+   target ("students.txt" -> "students.txt.tmpXXXXXX"), which is then renamed over it. A
+   crash or full disk mid-write leaves the old file intact, and readers in other processes
+   (including ones that have the binary format mapped) see either the old file or the new
+   one, never a half-written mix */
+
+static double elapsed_ms(const struct timespec *since) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - since->tv_sec) * 1000.0 +
+           (double)(now.tv_nsec - since->tv_nsec) / 1e6;
+}
+
+static ErrorCode atomic_open(const char *filename, const char *mode, AtomicFile *af) {
+    af->target = filename;
+    af->f = NULL;
+    af->temp_path = sidecar_path(filename, TEMP_SUFFIX);
+
+    if (!af->temp_path) {
+        return ERR_MEMORY;
+    }
+
+    int fd = mkstemp(af->temp_path);
+    if (fd < 0) {
+        free(af->temp_path);
+        return ERR_FILE_IO;
+    }
+
+    // mkstemp creates the file private to us; keep the permissions the old file had,
+    // or the ones fopen would have given a new file
+    struct stat st;
+    mode_t perms;
+    if (stat(filename, &st) == 0) {
+        perms = st.st_mode & 07777;
+    } else {
+        mode_t mask = umask(0);
+        umask(mask);
+        perms = 0666 & ~mask;
+    }
+    fchmod(fd, perms);
+
+    af->f = fdopen(fd, mode);
+    if (!af->f) {
+        close(fd);
+        unlink(af->temp_path);
+        free(af->temp_path);
+        return ERR_FILE_IO;
+    }
+
+    return SUCCESS;
+}
+
+/* Throws the temporary file away, leaving the target as it was */
+static void atomic_abort(AtomicFile *af) {
+    int saved_errno = errno;
+
+    fclose(af->f);
+    unlink(af->temp_path);
+    free(af->temp_path);
+    errno = saved_errno;
+}
+
+/* The rename is only durable once the directory entry is on disk too */
+static void sync_parent_dir(const char *filename) {
+    const char *slash = strrchr(filename, '/');
+    char *dir;
+
+    if (!slash) {
+        dir = safe_strdup(".");
+    } else if (slash == filename) {
+        dir = safe_strdup("/");
+    } else {
+        dir = malloc((size_t)(slash - filename) + 1);
+        if (dir) {
+            memcpy(dir, filename, (size_t)(slash - filename));
+            dir[slash - filename] = '\0';
+        }
+    }
+
+    if (!dir) {
+        return;
+    }
+
+    int fd = open(dir, O_RDONLY | O_DIRECTORY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+    free(dir);
+}
+
+/* Flushes the temporary file and renames it over the target. In SAVE_DURABLE mode the data
+   is fsync'ed before the rename and the directory after it, so the new file survives a
+   power loss; SAVE_FAST leaves that to the kernel. On failure the target is untouched and
+   errno says why. sync_ms, when not NULL, receives the time this step took */
+static ErrorCode atomic_commit(AtomicFile *af, SaveMode mode, double *sync_ms) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    int ok = fflush(af->f) == 0 && !ferror(af->f);
+    if (ok && mode == SAVE_DURABLE) {
+        ok = fsync(fileno(af->f)) == 0;
+    }
+
+    int saved_errno = errno;
+    if (fclose(af->f) != 0 && ok) {
+        ok = 0;
+        saved_errno = errno;
+    }
+
+    if (ok && rename(af->temp_path, af->target) != 0) {
+        ok = 0;
+        saved_errno = errno;
+    }
+
+    if (!ok) {
+        unlink(af->temp_path);
+    } else if (mode == SAVE_DURABLE) {
+        sync_parent_dir(af->target);
+    }
+
+    free(af->temp_path);
+    errno = saved_errno;
+
+    if (sync_ms) {
+        *sync_ms = elapsed_ms(&start);
+    }
+    return ok ? SUCCESS : ERR_FILE_IO;
+}
+
+/* ---------- File Locking ---------- */
+
+/* Several instances may use one data file at once. Each takes an advisory fcntl() lock on
+   FILENAME.lock while it touches the file: shared to read it (load, display, search,
+   statistics, top K) and exclusive to change it (saves, journal appends, background
+   saves). The data file can't carry the lock itself, since a full save renames a new file
+   over it; the lock file is never replaced.
+
+   The lock keeps writes from interleaving but can't stop an instance from saving a list it
+   read before someone else's save. So a save is also a compare-and-swap: under the
+   exclusive lock, the data file and journal must still match the stamps from when the
+   list was last loaded or saved, or the save is refused with ERR_CONFLICT.
+
+   fcntl() locks belong to the whole process, and closing any descriptor of the lock file
+   drops them all, so one process must never hold two at once. Our own writers already
+   take turns: every save waits for the background saver first */
+
+static ErrorCode file_lock(const char *filename, int exclusive, FileLock *lock) {
+    char *path = sidecar_path(filename, LOCK_SUFFIX);
+    lock->fd = -1;
+
+    if (!path) {
+        return ERR_MEMORY;
+    }
+
+    // Only writers create the lock file, so a session that just reads leaves nothing behind.
+    // Until some writer has made it there is nobody to wait for, bar one starting this very
+    // moment; its full saves still swap the file in with a rename. A shared lock needs no
+    // write access, so a lock file someone else made works too
+    int fd = exclusive ? open(path, O_RDWR | O_CREAT, 0666) : open(path, O_RDONLY);
+
+    // Without a lock file (none yet, read-only directory, someone else's file) we work
+    // unlocked, as before locking existed, rather than refuse to run
+    if (fd < 0) {
+        if (exclusive) {
+            fprintf(stderr, "Warning: Cannot open lock file '%s': %s\n", path, strerror(errno));
+        }
+        free(path);
+        return SUCCESS;
+    }
+    free(path);
+
+    struct flock fl;
+    memset(&fl, 0, sizeof(fl));
+    fl.l_type = exclusive ? F_WRLCK : F_RDLCK;
+    fl.l_whence = SEEK_SET;  // l_start and l_len 0: the whole file
+
+    int rc = fcntl(fd, F_SETLK, &fl);
+    if (rc != 0 && (errno == EACCES || errno == EAGAIN)) {
+        fprintf(stderr, "Waiting for another program using '%s'...\n", filename);
+        do {
+            rc = fcntl(fd, F_SETLKW, &fl);
+        } while (rc != 0 && errno == EINTR);
+    }
+
+    // A file system without lock support also falls back to working unlocked
+    if (rc != 0) {
+        close(fd);
+        return SUCCESS;
+    }
+
+    lock->fd = fd;
+    return SUCCESS;
+}
+
+static void file_unlock(FileLock *lock) {
+    if (lock->fd >= 0) {
+        close(lock->fd);
+        lock->fd = -1;
+    }
+}
+
+/* The compare half of the compare-and-swap. Like the journal's, an invalid base means the
+   file didn't exist when the list last looked, so one that has appeared since is a change.
+   A failed save must therefore keep or re-read the stamps, never drop them. A data file
+   that has since disappeared is simply written again */
+static int file_changed_since(const FileStamp *base, const FileStamp *journal_base,
+                              const char *filename) {
+    FileStamp current, journal;
+
+    if (file_stamp_read(filename, &current) == SUCCESS && !file_stamp_equal(base, &current)) {
+        return 1;
+    }
+
+    journal_stamp_read(filename, &journal);
+    return !journal_stamp_matches(journal_base, &journal);
+}
+
+/* Only a list that was loaded from or saved to this very file has a base to compare with */
+static int save_would_conflict(const StudentList *list, const char *filename) {
+    if (!list->last_filename || strcmp(list->last_filename, filename) != 0) {
+        return 0;
+    }
+
+    return file_changed_since(&list->file_stamp, &list->journal_stamp, filename);
+}
+
+static void report_conflict(const char *filename) {
+    fprintf(stderr, "Error: '%s' was changed by another program since it was loaded; "
+                    "not overwriting it. Reload it and make the change again.\n", filename);
+}
+
+/* ---------- Binary Record Format ---------- */
+
+/* Files whose name ends in BINARY_EXTENSION are saved in the binary format; everything else
+   stays as roll|marks|name text, which remains the format for interchange. Readers don't
+   trust the name and look for the magic bytes instead */
+static int is_binary_filename(const char *filename) {
+    size_t len = strlen(filename);
+    size_t ext = strlen(BINARY_EXTENSION);
+    return len > ext && strcmp(filename + len - ext, BINARY_EXTENSION) == 0;
+}
+
+/* Layout: header, then row_capacity fixed-width rows, then the name heap at names_offset.
+   Numbers are stored in host byte order. The rows past record_count are zeroed slack that
+   incremental saves append into; written receives the header as stored */
+static ErrorCode write_binary_records(const StudentList *list, FILE *f, BinaryHeader *written) {
+    uint64_t slack = list->size / BINARY_ROW_SLACK_DIVISOR;
+    if (slack < BINARY_MIN_ROW_SLACK) {
+        slack = BINARY_MIN_ROW_SLACK;
+    }
+
+    BinaryHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+    header.version = BINARY_VERSION;
+    header.row_size = sizeof(BinaryRow);
+    header.record_count = list->size;
+    header.row_capacity = list->size + slack;
+    header.names_offset = sizeof(BinaryHeader) + header.row_capacity * sizeof(BinaryRow);
+
+    uint64_t heap = 0;
+    for (size_t i = 0; i < list->size; i++) {
+        size_t len = strlen(list->items[i]->name);
+
+        if (len > BINARY_MAX_NAME) {
+            fprintf(stderr, "Error: The name of roll %d has %zu characters; the binary format "
+                            "holds at most %d, so save as text instead\n",
+                    list->items[i]->roll, len, BINARY_MAX_NAME);
+            errno = EOVERFLOW;  // What the caller's "Failed writing" message shows
+            return ERR_FILE_IO;
+        }
+        heap += len;
+    }
+
+    if (heap > UINT32_MAX) {
+        fprintf(stderr, "Error: Names are too large for the binary format\n");
+        errno = EOVERFLOW;
+        return ERR_FILE_IO;
+    }
+    header.names_size = heap;
+
+    fwrite(&header, sizeof(header), 1, f);
+
+    uint32_t offset = 0;
+    for (size_t i = 0; i < list->size; i++) {
+        const Student *s = list->items[i];
+        size_t len = strlen(s->name);
+        BinaryRow row;
+
+        row.roll = s->roll;
+        row.name_offset = offset;
+        row.name_length = (uint16_t)len;
+        row.marks = (uint8_t)s->marks;
+        row.flags = 0;
+        fwrite(&row, sizeof(row), 1, f);
+        offset += (uint32_t)len;
+    }
+
+    BinaryRow empty;
+    memset(&empty, 0, sizeof(empty));
+    for (uint64_t i = 0; i < slack; i++) {
+        fwrite(&empty, sizeof(empty), 1, f);
+    }
+
+    for (size_t i = 0; i < list->size; i++) {
+        fputs(list->items[i]->name, f);
+    }
+
+    *written = header;
+    return ferror(f) ? ERR_FILE_IO : SUCCESS;
+}
+
+/* Maps a binary record file read-only. Returns ERR_NOT_FOUND when fd isn't a binary record
+   file (so callers can fall back to text) and ERR_FILE_IO when it is one but damaged */
+static ErrorCode binary_map_fd(int fd, BinaryMap *map) {
+    BinaryHeader header;
+    struct stat st;
+
+    memset(map, 0, sizeof(*map));
+
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(header) ||
+        pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+        memcmp(header.magic, BINARY_MAGIC, sizeof(header.magic)) != 0) {
+        return ERR_NOT_FOUND;
+    }
+
+    uint64_t size = (uint64_t)st.st_size;
+    if (header.version != BINARY_VERSION || header.row_size != sizeof(BinaryRow) ||
+        header.record_count > header.row_capacity ||
+        header.row_capacity > (size - sizeof(header)) / sizeof(BinaryRow) ||
+        header.names_offset < sizeof(header) + header.row_capacity * sizeof(BinaryRow) ||
+        header.names_offset > size || header.names_size > size - header.names_offset) {
+        fprintf(stderr, "Error: Binary record file is damaged or from another version\n");
+        return ERR_FILE_IO;
+    }
+
+    void *base = mmap(NULL, (size_t)size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "Error: Cannot map binary record file: %s\n", strerror(errno));
+        return ERR_FILE_IO;
+    }
+
+    map->base = base;
+    map->length = (size_t)size;
+    map->header = (const BinaryHeader *)base;
+    map->rows = (const BinaryRow *)((const unsigned char *)base + sizeof(BinaryHeader));
+    map->names = (const char *)base + header.names_offset;
+    return SUCCESS;
+}
+
+static ErrorCode binary_map_open(const char *filename, BinaryMap *map) {
+    int fd = open(filename, O_RDONLY);
+
+    if (fd < 0) {
+        memset(map, 0, sizeof(*map));
+        return ERR_NOT_FOUND;
+    }
+
+    ErrorCode err = binary_map_fd(fd, map);
+    close(fd);  // The mapping stays valid after the descriptor is closed
+    return err;
+}
+
+static void binary_map_close(BinaryMap *map) {
+    if (map->base) {
+        munmap(map->base, map->length);
+    }
+    memset(map, 0, sizeof(*map));
+}
+
+/* Returns a row's name (not NUL-terminated) or NULL if it points outside the heap */
+static const char *binary_row_name(const BinaryMap *map, const BinaryRow *row, size_t *len) {
+    if ((uint64_t)row->name_offset + row->name_length > map->header->names_size) {
+        return NULL;
+    }
+
+    *len = row->name_length;
+    return map->names + row->name_offset;
+}
+
+/* Copies a row's whole name into name (BINARY_MAX_NAME + 1 bytes) and NUL-terminates it.
+   NULL if the name points outside the heap */
+static char *binary_row_name_copy(const BinaryMap *map, const BinaryRow *row, char *name) {
+    size_t len;
+    const char *src = binary_row_name(map, row, &len);
+
+    if (!src) {
+        return NULL;
+    }
+
+    memcpy(name, src, len);
+    name[len] = '\0';
+    return name;
+}
+
+/* Records remember their rows, so that when every row was either loaded or a tombstone
+   the next save can patch this file instead of rewriting it */
+static size_t load_binary_records(StudentList *list, const BinaryMap *map) {
+    size_t loaded = 0;
+    uint64_t deleted = 0;
+    char *name = malloc(BINARY_MAX_NAME + 1);
+
+    if (!name) {
+        fprintf(stderr, "Error: Out of memory while reading file\n");
+        return 0;
+    }
+
+    for (uint64_t i = 0; i < map->header->record_count; i++) {
+        const BinaryRow *row = &map->rows[i];
+
+        if (row->flags & BINARY_ROW_DELETED) {
+            deleted++;
+            continue;
+        }
+
+        if (!binary_row_name_copy(map, row, name) || row->roll <= 0 || row->marks > MAX_MARKS) {
+            fprintf(stderr, "Warning: Invalid data at record %llu (skipped)\n",
+                    (unsigned long long)i + 1);
+            continue;
+        }
+
+        Student *s = create_student(list, row->roll, name, row->marks);
+        if (s && add_student(list, s) == SUCCESS) {
+            s->row = (int32_t)i;
+            s->dirty = 0;
+            loaded++;
+        } else {
+            free_student(list, s);
+            fprintf(stderr, "Warning: Duplicate roll %d at record %llu (skipped)\n",
+                    (int)row->roll, (unsigned long long)i + 1);
+        }
+    }
+    free(name);
+
+    if (loaded + deleted == map->header->record_count && map->header->record_count <= INT32_MAX) {
+        BinaryStore *st = &list->store;
+
+        st->valid = 1;
+        st->record_count = map->header->record_count;
+        st->row_capacity = map->header->row_capacity;
+        st->names_offset = map->header->names_offset;
+        st->names_size = map->header->names_size;
+        st->deleted_rows = deleted;
+    }
+
+    return loaded;
+}
+
+/* When entries is not NULL it receives each record's roll, line number and byte offset */
+static ErrorCode write_text_records(const StudentList *list, FILE *f, SidecarEntry *entries) {
+    uint64_t offset = 0;
+    uint32_t line = 3;
+
+    offset += (uint64_t)fprintf(f, "# Student Record System Data File\n");
+    offset += (uint64_t)fprintf(f, "# Format: roll|marks|name\n");
+    offset += (uint64_t)fprintf(f, "# Total records: %zu\n", list->size);
+    
+    for (size_t i = 0; i < list->size; i++) {
+        Student *s = list->items[i];
+
+        if (entries) {
+            entries[i].roll = s->roll;
+            entries[i].line = ++line;
+            entries[i].offset = offset;
+        }
+
+        int written = fprintf(f, "%d|%d|%s\n", s->roll, s->marks, s->name ? s->name : "");
+        if (written < 0) {
+            break;
+        }
+        offset += (uint64_t)written;
+    }
+
+    return ferror(f) ? ERR_FILE_IO : SUCCESS;
+}
+
+/* ---------- Incremental Save ---------- */
+
+/* A binary file that still is exactly what the list last loaded or saved doesn't need
+   rewriting: every record remembers its row, so a save appends the names of new and
+   changed records to the name heap, writes new records into the slack rows reserved after
+   the last used one, patches changed rows in place, blanks the rows of removed records
+   (tombstones) and finally rewrites the header. Nothing points at the appended bytes until
+   the rows and header that use them are written, so a crash part way leaves the old
+   records readable. When too much would change, or too much of the file is dead space,
+   save_to_file falls back to a full (atomic) rewrite, which also compacts the file */
+
+static ErrorCode pwrite_all(int fd, const void *data, size_t len, uint64_t offset) {
+    const char *p = data;
+
+    while (len > 0) {
+        ssize_t n = pwrite(fd, p, len, (off_t)offset);
+
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return ERR_FILE_IO;
+        }
+
+        p += n;
+        len -= (size_t)n;
+        offset += (uint64_t)n;
+    }
+
+    return SUCCESS;
+}
+
+/* After a full binary save the file holds items in order, row i for items[i] */
+static void store_adopt(StudentList *list, const BinaryHeader *written) {
+    BinaryStore *st = &list->store;
+
+    for (size_t i = 0; i < list->size; i++) {
+        list->items[i]->row = (int32_t)i;
+        list->items[i]->dirty = 0;
+    }
+
+    st->valid = (list->size <= INT32_MAX);
+    st->record_count = written->record_count;
+    st->row_capacity = written->row_capacity;
+    st->names_offset = written->names_offset;
+    st->names_size = written->names_size;
+    st->dead_bytes = 0;
+    st->deleted_rows = 0;
+    st->tombstone_count = 0;
+}
+
+/* Writes only what changed since the file was last loaded or saved. Returns ERR_NOT_FOUND
+   when that isn't possible or isn't worth it, so the caller does a full save instead */
+static ErrorCode save_binary_changes(StudentList *list, const char *filename) {
+    BinaryStore *st = &list->store;
+    FileStamp current;
+
+    if (!st->valid || !list->last_filename || strcmp(list->last_filename, filename) != 0 ||
+        file_stamp_read(filename, &current) != SUCCESS ||
+        !file_stamp_equal(&list->file_stamp, &current)) {
+        return ERR_NOT_FOUND;
+    }
+
+    size_t added = 0, changed = 0;
+    uint64_t name_bytes = 0;
+
+    for (size_t i = 0; i < list->size; i++) {
+        const Student *s = list->items[i];
+
+        if (s->row < 0) {
+            added++;
+        } else if (s->dirty) {
+            changed++;
+        } else {
+            continue;
+        }
+
+        // A full save reports a name too long for the format
+        size_t len = strlen(s->name);
+        if (len > BINARY_MAX_NAME) {
+            return ERR_NOT_FOUND;
+        }
+        name_bytes += len;
+    }
+
+    uint64_t rows_after = st->record_count + added;
+    if (rows_after > st->row_capacity || rows_after > INT32_MAX ||
+        st->names_size + name_bytes > UINT32_MAX ||
+        (changed + st->tombstone_count) * BINARY_REWRITE_FRACTION > list->size ||
+        (st->deleted_rows + st->tombstone_count) * BINARY_REWRITE_FRACTION > rows_after ||
+        st->dead_bytes * BINARY_REWRITE_FRACTION > st->names_size + name_bytes) {
+        return ERR_NOT_FOUND;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    int fd = open(filename, O_RDWR);
+    if (fd < 0) {
+        return ERR_FILE_IO;
+    }
+
+    // New rows first (in items order), then the changed ones with their row numbers
+    char *heap = malloc(name_bytes + 1);
+    BinaryRow *rows = malloc((added + changed + 1) * sizeof(BinaryRow));
+    uint64_t *where = malloc((changed + 1) * sizeof(uint64_t));
+    ErrorCode err = (heap && rows && where) ? SUCCESS : ERR_MEMORY;
+
+    size_t a = 0, c = 0;
+    uint64_t heap_len = 0;
+
+    for (size_t i = 0; i < list->size && err == SUCCESS; i++) {
+        Student *s = list->items[i];
+
+        if (s->row >= 0 && !s->dirty) {
+            continue;
+        }
+
+        size_t len = strlen(s->name);
+        BinaryRow *row;
+
+        if (s->row < 0) {
+            row = &rows[a];
+            s->row = (int32_t)(st->record_count + a);
+            a++;
+        } else {
+            row = &rows[added + c];
+            where[c++] = (uint64_t)s->row;
+        }
+
+        row->roll = s->roll;
+        row->name_offset = (uint32_t)(st->names_size + heap_len);
+        row->name_length = (uint16_t)len;
+        row->marks = (uint8_t)s->marks;
+        row->flags = 0;
+        memcpy(heap + heap_len, s->name, len);
+        heap_len += len;
+        s->dirty = 0;
+    }
+
+    uint64_t rows_offset = sizeof(BinaryHeader);
+    uint64_t written = 0;
+
+    BinaryHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+    header.version = BINARY_VERSION;
+    header.row_size = sizeof(BinaryRow);
+    header.record_count = rows_after;
+    header.row_capacity = st->row_capacity;
+    header.names_offset = st->names_offset;
+    header.names_size = st->names_size + heap_len;
+
+    // Appended names and rows become part of the file through the header before any existing
+    // row is patched to point at them, and in durable mode they reach the disk first. A crash
+    // part way leaves each row either old or new, never pointing past names_size
+    if (err == SUCCESS) {
+        err = pwrite_all(fd, heap, heap_len, st->names_offset + st->names_size);
+    }
+    if (err == SUCCESS) {
+        err = pwrite_all(fd, rows, added * sizeof(BinaryRow),
+                         rows_offset + st->record_count * sizeof(BinaryRow));
+    }
+    if (err == SUCCESS) {
+        err = pwrite_all(fd, &header, sizeof(header), 0);
+    }
+    if (err == SUCCESS && list->save_mode == SAVE_DURABLE && fdatasync(fd) != 0) {
+        err = ERR_FILE_IO;
+    }
+
+    for (size_t i = 0; i < changed && err == SUCCESS; i++) {
+        err = pwrite_all(fd, &rows[added + i], sizeof(BinaryRow),
+                         rows_offset + where[i] * sizeof(BinaryRow));
+    }
+
+    BinaryRow tombstone;
+    memset(&tombstone, 0, sizeof(tombstone));
+    tombstone.flags = BINARY_ROW_DELETED;
+
+    for (size_t i = 0; i < st->tombstone_count && err == SUCCESS; i++) {
+        err = pwrite_all(fd, &tombstone, sizeof(tombstone),
+                         rows_offset + st->tombstones[i] * sizeof(BinaryRow));
+    }
+
+    list->last_save.write_ms = elapsed_ms(&start);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if (err == SUCCESS && list->save_mode == SAVE_DURABLE && fsync(fd) != 0) {
+        err = ERR_FILE_IO;
+    }
+
+    int saved_errno = errno;
+    if (close(fd) != 0 && err == SUCCESS) {
+        err = ERR_FILE_IO;
+        saved_errno = errno;
+    }
+    list->last_save.sync_ms = elapsed_ms(&start);
+
+    if (err == SUCCESS) {
+        written = heap_len + (added + changed + st->tombstone_count) * sizeof(BinaryRow) +
+                  sizeof(header);
+        list->last_save.bytes = written;
+        st->record_count = rows_after;
+        st->names_size += heap_len;
+        st->deleted_rows += st->tombstone_count;
+        st->tombstone_count = 0;
+    }
+
+    free(heap);
+    free(rows);
+    free(where);
+    errno = saved_errno;
+    return (err == ERR_MEMORY) ? ERR_NOT_FOUND : err;
+}
+
+/* Writes every record of list to filename through a temporary file and replaces the old
+   file in one rename, then refreshes the .idx sidecar. It touches nothing in list, so the
+   background saver can run it on a snapshot. stamp receives the new file's identity and
+   written (binary files only) the header as stored */
+static ErrorCode write_full_file(const StudentList *list, const char *filename, SaveMode mode,
+                                 SaveTiming *timing, BinaryHeader *written, FileStamp *stamp) {
+    int binary = is_binary_filename(filename);
+    struct timespec start;
+    AtomicFile af;
+
+    memset(written, 0, sizeof(*written));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (atomic_open(filename, binary ? "wb" : "w", &af) != SUCCESS) {
+        fprintf(stderr, "Error: Cannot open '%s' for writing: %s\n",
+                filename, strerror(errno));
+        return ERR_FILE_IO;
+    }
+
+    SidecarEntry *entries = binary ? NULL : malloc((list->size + 1) * sizeof(SidecarEntry));
+    ErrorCode err = binary ? write_binary_records(list, af.f, written)
+                           : write_text_records(list, af.f, entries);
+    timing->write_ms = elapsed_ms(&start);
+    timing->bytes = (uint64_t)ftell(af.f);
+
+    // The file on disk is only replaced once the new contents are complete
+    if (err != SUCCESS) {
+        atomic_abort(&af);
+    } else {
+        err = atomic_commit(&af, mode, &timing->sync_ms);
+    }
+
+    if (err != SUCCESS) {
+        fprintf(stderr, "Error: Failed writing '%s': %s\n", filename, strerror(errno));
+        free(entries);
+        return ERR_FILE_IO;
+    }
+
+    file_stamp_read(filename, stamp);
+    sidecar_write(filename, entries, list->size, stamp);
+    free(entries);
+    return SUCCESS;
+}
+
+/* Caller holds the exclusive lock on filename (see File Locking) */
+static ErrorCode save_to_file_locked(StudentList *list, const char *filename) {
+    int binary = is_binary_filename(filename);
+
+    // A binary file that still matches the list only needs the changed rows written
+    ErrorCode write_err = binary ? save_binary_changes(list, filename) : ERR_NOT_FOUND;
+
+    if (write_err == ERR_NOT_FOUND) {
+        BinaryHeader written;
+
+        write_err = write_full_file(list, filename, list->save_mode, &list->last_save,
+                                    &written, &list->file_stamp);
+        if (write_err == SUCCESS && binary) {
+            store_adopt(list, &written);
+        } else {
+            store_reset(list);
+        }
+    } else if (write_err != SUCCESS) {
+        fprintf(stderr, "Error: Failed writing '%s': %s\n", filename, strerror(errno));
+        store_reset(list);  // A half-patched file is rewritten in full next time
+
+        // Nobody else wrote it while we hold the lock, so its new identity is still ours
+        file_stamp_read(filename, &list->file_stamp);
+    }
+
+    // A failed full write never replaced the file, so the stamps from before still hold
+    if (write_err != SUCCESS) {
+        return ERR_FILE_IO;
+    }
+    
+    // Update last filename and clear modified flag
+    if (remember_filename(list, filename) != SUCCESS) {
+        return ERR_MEMORY;
+    }
+    file_stamp_read(filename, &list->file_stamp);
+
+    // Everything the journal recorded is in the file now
+    journal_remove(filename);
+    list->journal_stamp.valid = 0;
+    list->modified = 0;
+    return SUCCESS;
+}
+
+/* This part of the code does this: it saves all students to a text file using the format roll|marks|name
+   so the data can be stored permanently and loaded later (or to the binary format for .bin files).
+   It refuses with ERR_CONFLICT if another program changed the file since we last read it */
+static ErrorCode save_to_file(StudentList *list, const char *filename) {
+    if (!list || !filename) {
+        return ERR_INVALID_INPUT;
+    }
+
+    // A background write of an older state must not land on top of this one
+    async_save_settle(list, 1);
+
+    FileLock lock;
+    if (file_lock(filename, 1, &lock) != SUCCESS) {
+        return ERR_MEMORY;
+    }
+
+    if (save_would_conflict(list, filename)) {
+        file_unlock(&lock);
+        report_conflict(filename);
+        list->conflict = 1;
+        return ERR_CONFLICT;
+    }
+
+    ErrorCode err = save_to_file_locked(list, filename);
+    file_unlock(&lock);
+
+    if (err == SUCCESS) {
+        list->conflict = 0;
+    }
+    return err;
+}
+
+static size_t load_text_records(StudentList *list, int fd) {
+    LineScanner sc;
+    size_t loaded = 0;
+
+    if (line_scanner_open(&sc, fd, 0, -1) != SUCCESS) {
+        fprintf(stderr, "Error: Out of memory while reading file\n");
+        return 0;
+    }
+
+    char *line;
+    size_t len;
+    off_t offset;
+
+    while (line_scanner_next(&sc, &line, &len, &offset)) {
+        ParsedRecord rec;
+        ParseResult res = parse_record_line(line, len, &rec);
+
+        if (res == PARSE_SKIP) {
+            continue;
+        }
+
+        if (res == PARSE_BAD_FORMAT) {
+            fprintf(stderr, "Warning: Invalid format at line %zu\n", sc.line_num);
+            continue;
+        }
+
+        if (res == PARSE_BAD_DATA) {
+            fprintf(stderr, "Warning: Invalid data at line %zu (skipped)\n", sc.line_num);
+            continue;
+        }
+        
+        Student *s = create_student(list, rec.roll, rec.name, rec.marks);
+        if (s && add_student(list, s) == SUCCESS) {
+            loaded++;
+        } else {
+            free_student(list, s);
+            fprintf(stderr, "Warning: Duplicate roll %d at line %zu (skipped)\n",
+                    rec.roll, sc.line_num);
+        }
+    }
+
+    line_scanner_close(&sc);
+    return loaded;
+}
+
+/* Caller holds a shared lock on filename, which keeps the data file and its journal from
+   changing between reading one and the other */
+static ErrorCode load_from_file_locked(StudentList *list, const char *filename) {
+    int fd = open_for_reading(filename);
+    if (fd < 0) {
+        return ERR_FILE_IO;
+    }
+    
+    // Remember the file's identity before reading, so a write that races with us is noticed next time
+    struct stat st;
+    if (fstat(fd, &st) == 0) {
+        file_stamp_from_stat(&st, &list->file_stamp);
+    } else {
+        list->file_stamp.valid = 0;
+    }
+
+    BinaryMap map;
+    ErrorCode map_err = binary_map_fd(fd, &map);
+    if (map_err == ERR_FILE_IO) {
+        close(fd);
+        return ERR_FILE_IO;
+    }
+
+    // Clear existing list; the arena gives all records and names back at once
+    arena_reset(&list->arena);
+    list->size = 0;
+    stats_reset(list);
+    roll_index_rebuild(list);
+    views_invalidate(list);
+    store_reset(list);
+
+    size_t loaded;
+    if (map_err == SUCCESS) {
+        loaded = load_binary_records(list, &map);
+        binary_map_close(&map);
+    } else {
+        loaded = load_text_records(list, fd);
+    }
+    
+    close(fd);
+
+    size_t replayed = journal_replay(list, filename);
+    
+    // Update last filename and clear modified flag
+    if (remember_filename(list, filename) != SUCCESS) {
+        return ERR_MEMORY;
+    }
+    list->modified = 0;
+    
+    printf("Loaded %zu records from '%s'\n", loaded, filename);
+    if (replayed > 0) {
+        printf("Applied %zu journaled changes\n", replayed);
+    }
+    return SUCCESS;
+}
+
+static ErrorCode load_from_file(StudentList *list, const char *filename) {
+    if (!list || !filename) {
+        return ERR_INVALID_INPUT;
+    }
+
+    async_save_settle(list, 1);  // Read the file only once our own writes have landed
+
+    FileLock lock;
+    if (file_lock(filename, 0, &lock) != SUCCESS) {
+        return ERR_MEMORY;
+    }
+
+    ErrorCode err = load_from_file_locked(list, filename);
+    file_unlock(&lock);
+
+    if (err == SUCCESS) {
+        list->conflict = 0;  // The list now holds whatever the other program saved
+    }
+    return err;
+}
+
+/* ---------- Bulk Import ---------- */
+
+/* An import parses every row into a staging batch first, then settles duplicates for the
+   whole batch with one sort on roll, and only then appends the survivors and rebuilds the
+   roll index once. Adding row by row would check and index each record separately */
+
+static void import_batch_free(StudentList *list, ImportBatch *batch) {
+    for (size_t i = 0; i < batch->count; i++) {
+        free_student(list, batch->rows[i].student);
+    }
+
+    free(batch->rows);
+    batch->rows = NULL;
+    batch->count = 0;
+    batch->capacity = 0;
+}
+
+static ErrorCode import_stage(StudentList *list, ImportBatch *batch, int roll, int marks,
+                              const char *name, size_t source) {
+    if (batch->count == batch->capacity) {
+        size_t new_capacity = batch->capacity ? batch->capacity * 2 : 1024;
+        ImportRow *rows = realloc(batch->rows, new_capacity * sizeof(ImportRow));
+
+        if (!rows) {
+            return ERR_MEMORY;
+        }
+        batch->rows = rows;
+        batch->capacity = new_capacity;
+    }
+
+    Student *s = create_student(list, roll, name, marks);
+    if (!s) {
+        return ERR_MEMORY;
+    }
+
+    ImportRow *row = &batch->rows[batch->count++];
+    row->student = s;
+    row->source = source;
+    row->winner = 0;
+    row->replaces = -1;
+    row->keep = 1;
+    return SUCCESS;
+}
+
+static ErrorCode import_stage_text(StudentList *list, ImportBatch *batch, int fd,
+                                   ImportSummary *summary) {
+    LineScanner sc;
+
+    if (line_scanner_open(&sc, fd, 0, -1) != SUCCESS) {
+        return ERR_MEMORY;
+    }
+
+    char *line;
+    size_t len;
+    off_t offset;
+    ErrorCode err = SUCCESS;
+
+    while (err == SUCCESS && line_scanner_next(&sc, &line, &len, &offset)) {
+        ParsedRecord rec;
+        ParseResult res = parse_record_line(line, len, &rec);
+
+        if (res == PARSE_SKIP) {
+            continue;
+        }
+
+        if (res == PARSE_BAD_FORMAT) {
+            fprintf(stderr, "Warning: Invalid format at line %zu\n", sc.line_num);
+            summary->invalid++;
+            continue;
+        }
+
+        if (res == PARSE_BAD_DATA) {
+            fprintf(stderr, "Warning: Invalid data at line %zu (skipped)\n", sc.line_num);
+            summary->invalid++;
+            continue;
+        }
+
+        err = import_stage(list, batch, rec.roll, rec.marks, rec.name, sc.line_num);
+    }
+
+    line_scanner_close(&sc);
+    return err;
+}
+
+static ErrorCode import_stage_binary(StudentList *list, ImportBatch *batch, const BinaryMap *map,
+                                     ImportSummary *summary) {
+    char *name = malloc(BINARY_MAX_NAME + 1);
+    if (!name) {
+        return ERR_MEMORY;
+    }
+
+    ErrorCode err = SUCCESS;
+
+    for (uint64_t i = 0; i < map->header->record_count; i++) {
+        const BinaryRow *row = &map->rows[i];
+
+        if (row->flags & BINARY_ROW_DELETED) {
+            continue;
+        }
+
+        if (!binary_row_name_copy(map, row, name) || row->roll <= 0 || row->marks > MAX_MARKS) {
+            fprintf(stderr, "Warning: Invalid data at record %llu (skipped)\n",
+                    (unsigned long long)i + 1);
+            summary->invalid++;
+            continue;
+        }
+
+        if (import_stage(list, batch, row->roll, row->marks, name, (size_t)i + 1) != SUCCESS) {
+            err = ERR_MEMORY;
+            break;
+        }
+    }
+
+    free(name);
+    return err;
+}
+
+/* Orders rows by roll, and rows with the same roll by their position in the file */
+static int cmp_import_row(const void *a, const void *b) {
+    const ImportRow *ra = *(const ImportRow *const *)a;
+    const ImportRow *rb = *(const ImportRow *const *)b;
+
+    if (ra->student->roll != rb->student->roll) {
+        return (ra->student->roll > rb->student->roll) - (ra->student->roll < rb->student->roll);
+    }
+
+    return (ra->source > rb->source) - (ra->source < rb->source);
+}
+
+/* Marks which rows survive under the policy and counts the rows that lost a conflict.
+   A losing row remembers where the row that beat it came from (0 when the record already
+   in the list won) */
+static ErrorCode import_resolve(const StudentList *list, ImportBatch *batch, ImportPolicy policy,
+                                size_t *conflicts) {
+    *conflicts = 0;
+
+    if (batch->count == 0) {
+        return SUCCESS;
+    }
+
+    ImportRow **order = malloc(batch->count * sizeof(ImportRow *));
+    if (!order) {
+        return ERR_MEMORY;
+    }
+
+    for (size_t i = 0; i < batch->count; i++) {
+        order[i] = &batch->rows[i];
+    }
+    qsort(order, batch->count, sizeof(ImportRow *), cmp_import_row);
+
+    size_t g = 0;
+    while (g < batch->count) {
+        int roll = order[g]->student->roll;
+        size_t h = g + 1;
+
+        while (h < batch->count && order[h]->student->roll == roll) {
+            h++;
+        }
+
+        long existing = find_index_by_roll(list, roll);
+        size_t keep = (policy == IMPORT_KEEP_LAST) ? h - 1 : g;
+
+        for (size_t i = g; i < h; i++) {
+            ImportRow *row = order[i];
+
+            if (i == keep && (existing < 0 || policy == IMPORT_KEEP_LAST)) {
+                row->replaces = existing;
+                continue;
+            }
+
+            row->keep = 0;
+            row->winner = (i == keep || (existing >= 0 && policy != IMPORT_KEEP_LAST))
+                              ? 0 : order[keep]->source;
+            (*conflicts)++;
+        }
+
+        g = h;
+    }
+
+    free(order);
+    return SUCCESS;
+}
+
+/* Reports every row that lost a conflict, in file order, like load_from_file's warnings */
+static void import_report(const ImportBatch *batch, ImportPolicy policy) {
+    const char *unit = batch->unit;
+
+    for (size_t i = 0; i < batch->count; i++) {
+        const ImportRow *row = &batch->rows[i];
+        int roll = row->student->roll;
+
+        if (row->keep) {
+            if (row->replaces >= 0) {
+                fprintf(stderr, "Warning: Roll %d at %s %zu replaces the existing record\n",
+                        roll, unit, row->source);
+            }
+            continue;
+        }
+
+        const char *level = (policy == IMPORT_REJECT) ? "Error" : "Warning";
+
+        if (row->winner == 0) {
+            fprintf(stderr, "%s: Roll %d at %s %zu already exists%s\n", level, roll, unit,
+                    row->source, (policy == IMPORT_REJECT) ? "" : " (skipped)");
+        } else if (policy == IMPORT_KEEP_LAST) {
+            fprintf(stderr, "%s: Duplicate roll %d at %s %zu (replaced by %s %zu)\n",
+                    level, roll, unit, row->source, unit, row->winner);
+        } else {
+            fprintf(stderr, "%s: Duplicate roll %d at %s %zu (first seen at %s %zu)\n",
+                    level, roll, unit, row->source, unit, row->winner);
+        }
+    }
+}
+
+/* Moves the surviving rows into the list: replacements take over their old slot, new
+   rolls are appended, and the index is rebuilt once at the end */
+static ErrorCode import_apply(StudentList *list, ImportBatch *batch, ImportSummary *summary) {
+    size_t appended = 0;
+
+    for (size_t i = 0; i < batch->count; i++) {
+        if (batch->rows[i].keep && batch->rows[i].replaces < 0) {
+            appended++;
+        }
+    }
+
+    if (reserve_capacity(list, list->size + appended) != SUCCESS) {
+        return ERR_MEMORY;
+    }
+
+    for (size_t i = 0; i < batch->count; i++) {
+        ImportRow *row = &batch->rows[i];
+        Student *s = row->student;
+
+        row->student = NULL;
+
+        if (!row->keep) {
+            free_student(list, s);
+            summary->skipped++;
+            continue;
+        }
+
+        size_t slot;
+        if (row->replaces >= 0) {
+            slot = (size_t)row->replaces;
+            stats_remove(list, list->items[slot]->marks);
+            store_touch(list, list->items[slot]);
+            s->row = list->items[slot]->row;  // Patched in place by an incremental save
+            free_student(list, list->items[slot]);
+            summary->replaced++;
+        } else {
+            slot = list->size++;
+            summary->added++;
+        }
+
+        list->items[slot] = s;
+        list->rolls[slot] = s->roll;
+        list->marks[slot] = (uint8_t)s->marks;
+        stats_add(list, s->marks);
+    }
+
+    if (summary->added + summary->replaced > 0) {
+        list->modified = 1;
+        views_invalidate(list);
+    }
+
+    return roll_index_rebuild(list);
+}
+
+/* This part imports every record from a text or binary data file into the list in one
+   go. Rows whose roll is already taken (in the list or earlier in the file) are settled
+   by policy; IMPORT_REJECT leaves the list untouched and returns ERR_DUPLICATE if any
+   conflict exists. Every conflict is reported with its line (or record) number */
+static ErrorCode import_from_file(StudentList *list, const char *filename, ImportPolicy policy,
+                                  ImportSummary *summary) {
+    if (!list || !filename || !summary) {
+        return ERR_INVALID_INPUT;
+    }
+
+    memset(summary, 0, sizeof(*summary));
+
+    int fd = open_for_reading(filename);
+    if (fd < 0) {
+        return ERR_FILE_IO;
+    }
+
+    BinaryMap map;
+    ErrorCode err = binary_map_fd(fd, &map);
+    if (err == ERR_FILE_IO) {
+        close(fd);
+        return ERR_FILE_IO;
+    }
+
+    ImportBatch batch = {NULL, 0, 0, (err == SUCCESS) ? "record" : "line"};
+
+    if (err == SUCCESS) {
+        err = import_stage_binary(list, &batch, &map, summary);
+        binary_map_close(&map);
+    } else {
+        err = import_stage_text(list, &batch, fd, summary);
+    }
+    close(fd);
+
+    size_t conflicts = 0;
+    if (err == SUCCESS) {
+        err = import_resolve(list, &batch, policy, &conflicts);
+    }
+
+    if (err == SUCCESS) {
+        import_report(&batch, policy);
+
+        if (policy == IMPORT_REJECT && conflicts > 0) {
+            summary->skipped = batch.count;
+            err = ERR_DUPLICATE;
+        } else {
+            err = import_apply(list, &batch, summary);
+        }
+    }
+
+    import_batch_free(list, &batch);
+    return err;
+}
+
+/* ---------- Write-Ahead Journal ---------- */
+
+/* The journal lives next to the data file ("students.txt" -> "students.txt.log") and holds one
+   line per change made since the data file was last written in full:
+     A|roll|marks|name          student added
+     M|old_roll|roll|marks|name student modified
+     D|roll                     student removed
+   load_from_file replays it over the data file, and save_to_file deletes it because a full
+   save already contains every change */
+static char *journal_path(const char *filename) {
+    return sidecar_path(filename, JOURNAL_SUFFIX);
+}
+
+static void journal_stamp_read(const char *filename, FileStamp *out) {
+    char *path = journal_path(filename);
+
+    if (!path) {
+        out->valid = 0;
+        return;
+    }
+
+    file_stamp_read(path, out);
+    free(path);
+}
+
+/* A journal that is missing both times also counts as unchanged */
+static int journal_stamp_matches(const FileStamp *known, const FileStamp *current) {
+    if (!known->valid && !current->valid) {
+        return 1;
+    }
+
+    return file_stamp_equal(known, current);
+}
+
+static void journal_remove(const char *filename) {
+    char *path = journal_path(filename);
+
+    if (path) {
+        remove(path);
+        free(path);
+    }
+}
+
+/* This block does: it writes one change as a single appended line instead of rewriting every
+   record. When the list isn't known to match the data file + journal (e.g. the first save),
+   or the journal has grown past the compaction threshold, it falls back to a full save.
+   With a background saver the change goes to it instead (see Background Save) */
+static ErrorCode journal_append(StudentList *list, const char *filename,
+                                JournalOp op, int roll, const Student *s) {
+    if (!list || !filename) {
+        return ERR_INVALID_INPUT;
+    }
+
+    if (list->saver) {
+        return async_save_submit(list, filename);
+    }
+
+    // The stamp check below is the compare-and-swap for appends, so it runs under the lock
+    FileLock lock;
+    if (file_lock(filename, 1, &lock) != SUCCESS) {
+        return ERR_MEMORY;
+    }
+
+    FileStamp base, journal;
+    file_stamp_read(filename, &base);
+    journal_stamp_read(filename, &journal);
+
+    // save_to_file takes the lock itself, and also tells a conflict from a first save
+    if (!list->journaled || !list->last_filename || strcmp(list->last_filename, filename) != 0 ||
+        !file_stamp_equal(&list->file_stamp, &base) ||
+        !journal_stamp_matches(&list->journal_stamp, &journal)) {
+        file_unlock(&lock);
+        return save_to_file(list, filename);
+    }
+
+    char *path = journal_path(filename);
+    if (!path) {
+        file_unlock(&lock);
+        return ERR_MEMORY;
+    }
+
+    FILE *f = fopen(path, "a");
+    if (!f) {
+        fprintf(stderr, "Error: Cannot open '%s' for appending: %s\n", path, strerror(errno));
+        free(path);
+        file_unlock(&lock);
+        return ERR_FILE_IO;
+    }
+
+    switch (op) {
+        case JOURNAL_ADD:
+            fprintf(f, "A|%d|%d|%s\n", s->roll, s->marks, s->name);
+            break;
+        case JOURNAL_MODIFY:
+            fprintf(f, "M|%d|%d|%d|%s\n", roll, s->roll, s->marks, s->name);
+            break;
+        case JOURNAL_DELETE:
+            fprintf(f, "D|%d\n", roll);
+            break;
+    }
+
+    if (fclose(f) != 0) {
+        fprintf(stderr, "Error: Failed writing '%s': %s\n", path, strerror(errno));
+
+        // Take back any part of the line that got written, so the change just stays unsaved,
+        // then stamp the journal as it is now: under the lock only we can have touched it
+        int undone = journal.valid ? truncate(path, (off_t)journal.size) : unlink(path);
+        if (undone != 0) {
+            fprintf(stderr, "Warning: Could not undo the partial write to '%s'\n", path);
+        }
+        file_stamp_read(path, &list->journal_stamp);
+        free(path);
+        file_unlock(&lock);
+        return ERR_FILE_IO;
+    }
+
+    file_stamp_read(path, &list->journal_stamp);
+    free(path);
+    file_unlock(&lock);
+    list->modified = 0;
+
+    // Fold the journal back in once it is a sizeable fraction of the data file
+    if (list->journal_stamp.size > JOURNAL_COMPACT_MIN_BYTES &&
+        list->journal_stamp.size > base.size / JOURNAL_COMPACT_RATIO) {
+        return save_to_file(list, filename);
+    }
+
+    return SUCCESS;
+}
+
+/* Parses "roll|marks|name" starting at p; name points into the line */
+static int journal_parse_record(char *p, int *roll, int *marks, char **name) {
+    char *end;
+
+    *roll = (int)strtol(p, &end, 10);
+    if (*end != '|') {
+        return 0;
+    }
+
+    *marks = (int)strtol(end + 1, &end, 10);
+    if (*end != '|') {
+        return 0;
+    }
+
+    *name = end + 1;
+    trim_inplace(*name);
+    return *roll > 0 && *marks >= 0 && *marks <= MAX_MARKS;
+}
+
+/* Applies the journal for filename to a list that has just been loaded from the data file */
+static size_t journal_replay(StudentList *list, const char *filename) {
+    char *path = journal_path(filename);
+    if (!path) {
+        return 0;
+    }
+
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        list->journal_stamp.valid = 0;
+        free(path);
+        return 0;
+    }
+
+    struct stat st;
+    if (fstat(fileno(f), &st) == 0) {
+        file_stamp_from_stat(&st, &list->journal_stamp);
+    } else {
+        list->journal_stamp.valid = 0;
+    }
+
+    // getline, not a fixed buffer: names are as long as the data file lets them be
+    char *buffer = NULL;
+    size_t buffer_cap = 0;
+    size_t line_num = 0;
+    size_t applied = 0;
+
+    while (getline(&buffer, &buffer_cap, f) != -1) {
+        line_num++;
+        buffer[strcspn(buffer, "\n")] = '\0';
+
+        int roll, new_roll, marks;
+        char *name, *end;
+        ErrorCode err = ERR_INVALID_INPUT;
+
+        if (buffer[0] != '\0' && buffer[1] == '|') {
+            switch (buffer[0]) {
+                case JOURNAL_ADD:
+                    if (journal_parse_record(buffer + 2, &roll, &marks, &name)) {
+                        Student *s = create_student(list, roll, name, marks);
+                        err = s ? add_student(list, s) : ERR_MEMORY;
+                        if (err != SUCCESS) {
+                            free_student(list, s);
+                        }
+                    }
+                    break;
+                case JOURNAL_MODIFY:
+                    roll = (int)strtol(buffer + 2, &end, 10);
+                    if (*end == '|' && journal_parse_record(end + 1, &new_roll, &marks, &name)) {
+                        long idx = find_index_by_roll(list, roll);
+                        err = idx < 0 ? ERR_NOT_FOUND
+                                      : modify_student(list, (size_t)idx, new_roll, name, marks);
+                    }
+                    break;
+                case JOURNAL_DELETE:
+                    roll = (int)strtol(buffer + 2, &end, 10);
+                    if (*end == '\0') {
+                        long idx = find_index_by_roll(list, roll);
+                        err = idx < 0 ? ERR_NOT_FOUND : remove_student_by_index(list, (size_t)idx);
+                    }
+                    break;
+            }
+        }
+
+        if (err == SUCCESS) {
+            applied++;
+        } else {
+            fprintf(stderr, "Warning: Journal entry at %s line %zu not applied\n", path, line_num);
+        }
+    }
+
+    free(buffer);
+    fclose(f);
+    free(path);
+    return applied;
+}
+
+/* Binary files are read straight out of the mapping, with no parsing */
+static ErrorCode display_binary_records(const char *filename, const BinaryMap *map) {
+    size_t count = 0;
+    OutputBuffer out;
+
+    printf("\nReading from file: %s\n", filename);
+    printf("------------------------------------------------------------------------------\n");
+
+    if (output_open(&out, STDOUT_FILENO) != SUCCESS) {
+        return ERR_MEMORY;
+    }
+
+    for (uint64_t i = 0; i < map->header->record_count; i++) {
+        const BinaryRow *row = &map->rows[i];
+        size_t len;
+        const char *name = binary_row_name(map, row, &len);
+
+        if (!name || row->roll <= 0 || row->marks > MAX_MARKS) {
+            continue;
+        }
+
+        if (len > MAX_NAME_LENGTH) {
+            len = MAX_NAME_LENGTH;
+        }
+
+        count++;
+        output_student_row(&out, count, row->roll, name, len, row->marks);
+    }
+    output_close(&out);
+
+    if (count == 0) {
+        printf("No student records found in the file.\n");
+    } else {
+        printf("----------------------------------------------------------------------------\n");
+        printf("Total records in file: %zu\n", count);
+    }
+
+    return SUCCESS;
+}
+
+/* Page renderers for display_from_file: each seeks straight to its first record */
+static void render_text_page(void *ctx, size_t first, size_t count, OutputBuffer *out) {
+    const FilePage *fp = ctx;
+    LineScanner sc;
+
+    if (line_scanner_open(&sc, fp->fd, (off_t)fp->index.positions[first], -1) != SUCCESS) {
+        return;
+    }
+
+    char *line;
+    size_t len;
+    off_t offset;
+    size_t shown = 0;
+
+    while (shown < count && line_scanner_next(&sc, &line, &len, &offset)) {
+        ParsedRecord rec;
+
+        if (parse_record_line(line, len, &rec) != PARSE_RECORD) {
+            continue;
+        }
+
+        size_t name_len = rec.name_len > MAX_NAME_LENGTH ? MAX_NAME_LENGTH : rec.name_len;
+        shown++;
+        output_student_row(out, first + shown, rec.roll, rec.name, name_len, rec.marks);
+    }
+
+    line_scanner_close(&sc);
+}
+
+static void render_binary_page(void *ctx, size_t first, size_t count, OutputBuffer *out) {
+    const FilePage *fp = ctx;
+
+    for (size_t i = first; i < first + count; i++) {
+        const BinaryRow *row = &fp->map->rows[fp->index.positions[i]];
+        size_t len = 0;
+        const char *name = binary_row_name(fp->map, row, &len);
+
+        output_student_row(out, i + 1, row->roll, name,
+                           len > MAX_NAME_LENGTH ? MAX_NAME_LENGTH : len, row->marks);
+    }
+}
+
+/* One pass over a text file noting where each record starts; nothing is formatted */
+static ErrorCode index_text_records(int fd, RecordIndex *idx) {
+    LineScanner sc;
+    if (line_scanner_open(&sc, fd, 0, -1) != SUCCESS) {
+        return ERR_MEMORY;
+    }
+
+    char *line;
+    size_t len;
+    off_t offset;
+    ErrorCode err = SUCCESS;
+
+    while (err == SUCCESS && line_scanner_next(&sc, &line, &len, &offset)) {
+        ParsedRecord rec;
+
+        if (parse_record_line(line, len, &rec) == PARSE_RECORD) {
+            err = record_index_add(idx, (uint64_t)offset);
+        }
+    }
+
+    line_scanner_close(&sc);
+    return err;
+}
+
+/* Paged version of display_from_file: index the records, then page through them */
+static ErrorCode page_from_file(const char *filename, int fd, const BinaryMap *map) {
+    FilePage fp;
+    ErrorCode err = SUCCESS;
+
+    memset(&fp, 0, sizeof(fp));
+    fp.fd = fd;
+    fp.map = map;
+
+    if (map) {
+        for (uint64_t i = 0; i < map->header->record_count && err == SUCCESS; i++) {
+            const BinaryRow *row = &map->rows[i];
+            size_t len;
+
+            if (binary_row_name(map, row, &len) && row->roll > 0 && row->marks <= MAX_MARKS) {
+                err = record_index_add(&fp.index, i);
+            }
+        }
+    } else {
+        err = index_text_records(fd, &fp.index);
+    }
+
+    if (err == SUCCESS) {
+        printf("\nReading from file: %s\n", filename);
+        printf("------------------------------------------------------------------------------\n");
+
+        if (fp.index.count == 0) {
+            printf("No student records found in the file.\n");
+        } else {
+            err = run_pager(fp.index.count, map ? render_binary_page : render_text_page, &fp);
+            printf("----------------------------------------------------------------------------\n");
+            printf("Total records in file: %zu\n", fp.index.count);
+        }
+    }
+
+    record_index_free(&fp.index);
+    return err;
+}
+
+/* Reads and displays all student records directly from file without loading into memory */
+static ErrorCode display_from_file_locked(const char *filename) {
+    if (!filename) {
+        return ERR_INVALID_INPUT;
+    }
+
+    BinaryMap map;
+    ErrorCode map_err = binary_map_open(filename, &map);
+    if (map_err == SUCCESS) {
+        ErrorCode err = pager_enabled() ? page_from_file(filename, -1, &map)
+                                        : display_binary_records(filename, &map);
+        binary_map_close(&map);
+        return err;
+    } else if (map_err == ERR_FILE_IO) {
+        return ERR_FILE_IO;
+    }
+    
+    int fd = open_for_reading(filename);
+    if (fd < 0) {
+        return ERR_FILE_IO;
+    }
+
+    if (pager_enabled()) {
+        ErrorCode err = page_from_file(filename, fd, NULL);
+        close(fd);
+        return err;
+    }
+
+    LineScanner sc;
+    if (line_scanner_open(&sc, fd, 0, -1) != SUCCESS) {
+        close(fd);
+        return ERR_MEMORY;
+    }
+    
+    size_t count = 0;
+    char *line;
+    size_t len;
+    off_t offset;
+    OutputBuffer out;
+    
+    printf("\nReading from file: %s\n", filename);
+    printf("------------------------------------------------------------------------------\n");
+
+    if (output_open(&out, STDOUT_FILENO) != SUCCESS) {
+        line_scanner_close(&sc);
+        close(fd);
+        return ERR_MEMORY;
+    }
+
+    while (line_scanner_next(&sc, &line, &len, &offset)) {
+        ParsedRecord rec;
+
+        if (parse_record_line(line, len, &rec) != PARSE_RECORD) {
+            continue;
+        }
+        
+        // Show at most MAX_NAME_LENGTH characters of the name
+        size_t name_len = rec.name_len > MAX_NAME_LENGTH ? MAX_NAME_LENGTH : rec.name_len;
+        
+        // Display the student
+        count++;
+        output_student_row(&out, count, rec.roll, rec.name, name_len, rec.marks);
+    }
+    
+    output_close(&out);
+    line_scanner_close(&sc);
+    close(fd);
+    
+    if (count == 0) {
+        printf("No student records found in the file.\n");
+    } else {
+        printf("----------------------------------------------------------------------------\n");
+        printf("Total records in file: %zu\n", count);
+    }
+    
+    return SUCCESS;
+}
+
+/* The shared lock is held for as long as the pager is open, so a save by another
+   instance waits until the listing is closed */
+static ErrorCode display_from_file(const char *filename) {
+    if (!filename) {
+        return ERR_INVALID_INPUT;
+    }
+
+    FileLock lock;
+    if (file_lock(filename, 0, &lock) != SUCCESS) {
+        return ERR_MEMORY;
+    }
+
+    ErrorCode err = display_from_file_locked(filename);
+    file_unlock(&lock);
+    return err;
+}
+
+/* Looks through the dense roll column of a mapped binary file */
+static int search_binary_records(const BinaryMap *map, int roll) {
+    for (uint64_t i = 0; i < map->header->record_count; i++) {
+        const BinaryRow *row = &map->rows[i];
+
+        if (row->roll != roll) {
+            continue;
+        }
+
+        size_t len;
+        const char *name = binary_row_name(map, row, &len);
+
+        if (name && roll > 0 && row->marks <= MAX_MARKS) {
+            printf("Found at record %llu:\n", (unsigned long long)i + 1);
+            printf("Roll: %-5d Name: %-30.*s Marks: %3d [%s]\n",
+                   roll, (int)len, name, row->marks,
+                   (row->marks >= PASS_THRESHOLD) ? "PASS" : "FAIL");
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* ---------- Background Save ---------- */
+
+/* With --async-save, a single change (the journal_append path of options 1-3) doesn't
+   write anything on the menu's thread. It copies the records into a snapshot, hands it to
+   a saver thread and returns. Each snapshot carries a generation number; one that arrives
+   while an older one is still waiting replaces it, so a burst of changes costs one write.
+   Anything that needs the file itself to be current (a full save, a load, the file readers
+   behind compact_journal, the exit prompt) waits for the saver first */
+
+static void save_snapshot_free(SaveSnapshot *snap) {
+    if (snap) {
+        free(snap->filename);
+        free(snap->items);
+        free(snap->records);
+        free(snap->names);
+        free(snap);
+    }
+}
+
+/* Copies every record (names included) so the saver never looks at the live list */
+static SaveSnapshot *save_snapshot_take(const StudentList *list, const char *filename) {
+    SaveSnapshot *snap = calloc(1, sizeof(SaveSnapshot));
+    if (!snap) {
+        return NULL;
+    }
+
+    size_t name_bytes = 0;
+    for (size_t i = 0; i < list->size; i++) {
+        name_bytes += strlen(list->items[i]->name) + 1;
+    }
+
+    snap->filename = safe_strdup(filename);
+    snap->items = malloc((list->size + 1) * sizeof(Student *));
+    snap->records = malloc((list->size + 1) * sizeof(Student));
+    snap->names = malloc(name_bytes + 1);
+    snap->size = list->size;
+
+    if (!snap->filename || !snap->items || !snap->records || !snap->names) {
+        save_snapshot_free(snap);
+        return NULL;
+    }
+
+    char *p = snap->names;
+    for (size_t i = 0; i < list->size; i++) {
+        const Student *s = list->items[i];
+        size_t len = strlen(s->name) + 1;
+
+        memcpy(p, s->name, len);
+        snap->records[i] = *s;
+        snap->records[i].name = p;
+        snap->items[i] = &snap->records[i];
+        p += len;
+    }
+
+    return snap;
+}
+
+/* A snapshot's base is what the list was last in sync with when it was taken. Our own
+   earlier writes can land after that, so the file may also match the last one of those.
+   While the saver is busy only its own thread changes stamp, journal and stamped, so it
+   can read them unlocked */
+static int async_save_conflicts(const AsyncSaver *saver, const SaveSnapshot *snap) {
+    if (!file_changed_since(&snap->base, &snap->journal, snap->filename)) {
+        return 0;
+    }
+
+    return !saver->stamped || file_changed_since(&saver->stamp, &saver->journal, snap->filename);
+}
+
+static void *async_saver_main(void *arg) {
+    AsyncSaver *saver = arg;
+
+    pthread_mutex_lock(&saver->lock);
+
+    for (;;) {
+        while (!saver->pending && !saver->stop) {
+            pthread_cond_wait(&saver->wake, &saver->lock);
+        }
+
+        if (!saver->pending) {
+            break;  // Stopping, and everything handed over has been written
+        }
+
+        SaveSnapshot *snap = saver->pending;
+        saver->pending = NULL;
+        saver->busy = 1;
+        pthread_mutex_unlock(&saver->lock);
+
+        // write_full_file only needs items and size, so the snapshot stands in for a list
+        StudentList view;
+        BinaryHeader written;
+        SaveTiming timing;
+        FileStamp stamp;
+
+        memset(&view, 0, sizeof(view));
+        view.items = snap->items;
+        view.size = snap->size;
+
+        FileLock lock;
+        FileStamp journal;
+        int conflict = 0;
+        int stamped = 0;
+        ErrorCode err = file_lock(snap->filename, 1, &lock);
+
+        if (err == SUCCESS) {
+            conflict = async_save_conflicts(saver, snap);
+            err = conflict ? ERR_CONFLICT
+                           : write_full_file(&view, snap->filename, saver->mode, &timing,
+                                             &written, &stamp);
+            if (err == SUCCESS) {
+                journal_remove(snap->filename);
+                journal.valid = 0;
+                stamped = 1;
+            } else if (!conflict) {
+                // The file passed the conflict check and wasn't replaced, so it is still one
+                // the list knows; record it as it stands
+                file_stamp_read(snap->filename, &stamp);
+                journal_stamp_read(snap->filename, &journal);
+                stamped = 1;
+            }
+            file_unlock(&lock);
+        }
+
+        if (conflict) {
+            report_conflict(snap->filename);
+        }
+
+        pthread_mutex_lock(&saver->lock);
+        saver->busy = 0;
+        if (stamped) {
+            saver->stamp = stamp;
+            saver->journal = journal;
+            saver->stamped = 1;
+        }
+        if (err == SUCCESS) {
+            saver->written = snap->generation;
+        } else {
+            saver->failed = 1;
+            saver->conflict = conflict;
+        }
+        pthread_cond_broadcast(&saver->idle);
+        save_snapshot_free(snap);
+    }
+
+    pthread_mutex_unlock(&saver->lock);
+    return NULL;
+}
+
+static ErrorCode async_save_start(StudentList *list) {
+    AsyncSaver *saver = calloc(1, sizeof(AsyncSaver));
+    if (!saver) {
+        return ERR_MEMORY;
+    }
+
+    saver->mode = list->save_mode;
+    pthread_mutex_init(&saver->lock, NULL);
+    pthread_cond_init(&saver->wake, NULL);
+    pthread_cond_init(&saver->idle, NULL);
+
+    if (pthread_create(&saver->thread, NULL, async_saver_main, saver) != 0) {
+        pthread_mutex_destroy(&saver->lock);
+        pthread_cond_destroy(&saver->wake);
+        pthread_cond_destroy(&saver->idle);
+        free(saver);
+        return ERR_MEMORY;
+    }
+
+    list->saver = saver;
+    return SUCCESS;
+}
+
+/* Takes in what the saver has finished. With wait set it first blocks until nothing is
+   pending. Returns 1 while a write is still queued or running (only possible without
+   wait); the list is then newer than the file and must not be reloaded from it */
+static int async_save_settle(StudentList *list, int wait) {
+    AsyncSaver *saver = list->saver;
+
+    if (!saver) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&saver->lock);
+
+    if (wait) {
+        while (saver->pending || saver->busy) {
+            pthread_cond_wait(&saver->idle, &saver->lock);
+        }
+    }
+
+    int in_flight = saver->pending || saver->busy;
+    int failed = saver->failed;
+    int conflict = saver->conflict;
+
+    if (!in_flight && !failed && saver->requested > 0 && saver->written == saver->requested) {
+        // The file is exactly the last snapshot, so the list is in sync with it again
+        list->file_stamp = saver->stamp;
+        list->journal_stamp = saver->journal;
+    } else if (failed && !conflict && saver->stamped) {
+        // Still the file the list was saved to (or our newer writes), just not up to date
+        list->file_stamp = saver->stamp;
+        list->journal_stamp = saver->journal;
+    }
+    if (!in_flight) {
+        saver->stamped = 0;  // The list has caught up with everything the saver saw
+    }
+    saver->failed = 0;
+    saver->conflict = 0;
+    pthread_mutex_unlock(&saver->lock);
+
+    if (failed) {
+        printf("Warning: A background save failed; your latest changes are not saved yet.\n");
+        list->modified = 1;
+
+        // After a conflict the old stamp must stay, so later saves are refused as well
+        if (conflict) {
+            list->conflict = 1;
+        }
+    }
+
+    return in_flight;
+}
+
+/* Hands the whole list to the saver. Falls back to a normal save if there is no memory
+   for the snapshot */
+static ErrorCode async_save_submit(StudentList *list, const char *filename) {
+    AsyncSaver *saver = list->saver;
+    SaveSnapshot *snap = save_snapshot_take(list, filename);
+
+    // calloc left both stamps invalid; they only apply to the file the list came from
+    if (snap && list->last_filename && strcmp(list->last_filename, filename) == 0) {
+        snap->base = list->file_stamp;
+        snap->journal = list->journal_stamp;
+    }
+
+    if (!snap || remember_filename(list, filename) != SUCCESS) {
+        save_snapshot_free(snap);
+        return save_to_file(list, filename);
+    }
+
+    pthread_mutex_lock(&saver->lock);
+    snap->generation = ++saver->requested;
+    if (saver->pending) {
+        save_snapshot_free(saver->pending);  // Never started; this snapshot includes its changes
+        saver->coalesced++;
+    }
+    saver->pending = snap;
+    pthread_cond_signal(&saver->wake);
+    pthread_mutex_unlock(&saver->lock);
+
+    // The saver owns the change now. Rows in a binary file are rewritten in full by it
+    list->modified = 0;
+    store_reset(list);
+    return SUCCESS;
+}
+
+/* Writes whatever is still pending, then stops the thread */
+static void async_save_stop(StudentList *list) {
+    AsyncSaver *saver = list->saver;
+
+    if (!saver) {
+        return;
+    }
+
+    pthread_mutex_lock(&saver->lock);
+    saver->stop = 1;
+    pthread_cond_signal(&saver->wake);
+    pthread_mutex_unlock(&saver->lock);
+
+    pthread_join(saver->thread, NULL);
+    async_save_settle(list, 0);
+
+    list->saver = NULL;
+    save_snapshot_free(saver->pending);
+    pthread_mutex_destroy(&saver->lock);
+    pthread_cond_destroy(&saver->wake);
+    pthread_cond_destroy(&saver->idle);
+    free(saver);
+}
+
+/* ---------- On-Disk Roll Index ---------- */
+
+/* Text saves also write FILENAME.idx: every (roll, line, byte offset) in the data file,
+   sorted by roll, plus the data file's size, mtime, device and inode at the time. search_in_file can then
+   binary search it and read one line, instead of scanning the whole file */
+static int cmp_sidecar_roll(const void *a, const void *b) {
+    const SidecarEntry *ea = a;
+    const SidecarEntry *eb = b;
+    return (ea->roll > eb->roll) - (ea->roll < eb->roll);
+}
+
+static void sidecar_write(const char *filename, SidecarEntry *entries, size_t count,
+                          const FileStamp *data) {
+    char *path = sidecar_path(filename, SIDECAR_SUFFIX);
+    if (!path) {
+        return;
+    }
+
+    if (!entries || !data->valid) {
+        remove(path);  // Better no index than one that doesn't describe the file
+        free(path);
+        return;
+    }
+
+    qsort(entries, count, sizeof(SidecarEntry), cmp_sidecar_roll);
+
+    SidecarHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SIDECAR_MAGIC, sizeof(header.magic));
+    header.version = SIDECAR_VERSION;
+    header.entry_size = sizeof(SidecarEntry);
+    header.data_size = (uint64_t)data->size;
+    header.data_mtime_sec = (int64_t)data->mtime_sec;
+    header.data_mtime_nsec = (int64_t)data->mtime_nsec;
+    header.data_dev = (uint64_t)data->dev;
+    header.data_ino = (uint64_t)data->ino;
+    header.count = count;
+
+    // The index can always be rebuilt from the data file, so it is replaced without fsync
+    AtomicFile af;
+    if (atomic_open(path, "wb", &af) == SUCCESS) {
+        fwrite(&header, sizeof(header), 1, af.f);
+        fwrite(entries, sizeof(SidecarEntry), count, af.f);
+
+        if (atomic_commit(&af, SAVE_FAST, NULL) != SUCCESS) {
+            remove(path);
+        }
+    }
+
+    free(path);
+}
+
+/* Looks roll up through the sidecar index. Returns 1 and fills line_num/offset on a hit,
+   0 on a definite miss, and -1 if the index is missing or doesn't match the data file */
+static int sidecar_lookup(const char *filename, int roll, size_t *line_num, off_t *offset) {
+    FileStamp data;
+    if (file_stamp_read(filename, &data) != SUCCESS) {
+        return -1;
+    }
+
+    char *path = sidecar_path(filename, SIDECAR_SUFFIX);
+    if (!path) {
+        return -1;
+    }
+
+    int fd = open(path, O_RDONLY);
+    free(path);
+    if (fd < 0) {
+        return -1;
+    }
+
+    SidecarHeader header;
+    struct stat st;
+    int result = -1;
+
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(header) &&
+        pread(fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header) &&
+        memcmp(header.magic, SIDECAR_MAGIC, sizeof(header.magic)) == 0 &&
+        header.version == SIDECAR_VERSION && header.entry_size == sizeof(SidecarEntry) &&
+        header.data_size == (uint64_t)data.size &&
+        header.data_mtime_sec == (int64_t)data.mtime_sec &&
+        header.data_mtime_nsec == (int64_t)data.mtime_nsec &&
+        header.data_dev == (uint64_t)data.dev && header.data_ino == (uint64_t)data.ino &&
+        header.count <= ((uint64_t)st.st_size - sizeof(header)) / sizeof(SidecarEntry)) {
+
+        size_t lo = 0, hi = (size_t)header.count;
+        result = 0;
+
+        // Binary search with one pread per probe; a miss stops here without touching the data file
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            SidecarEntry e;
+            off_t at = (off_t)(sizeof(header) + mid * sizeof(SidecarEntry));
+
+            if (pread(fd, &e, sizeof(e), at) != (ssize_t)sizeof(e)) {
+                result = -1;
+                break;
+            }
+
+            if (e.roll == roll) {
+                *line_num = e.line;
+                *offset = (off_t)e.offset;
+                result = 1;
+                break;
+            }
+
+            if (e.roll < roll) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+    }
+
+    close(fd);
+    return result;
+}
+
+/* Scans fd from start for roll and prints the student if found; line_num is the number of
+   the line before start. With single set only the line at start is looked at. Returns 1 if
+   found, 0 if not and -1 when out of memory */
+static int search_scan(int fd, int roll, off_t start, size_t line_num, int single) {
+    LineScanner sc;
+    if (line_scanner_open(&sc, fd, start, -1) != SUCCESS) {
+        return -1;
+    }
+    sc.line_num = line_num;
+
+    int found = 0;
+    char *line;
+    size_t len;
+    off_t offset;
+
+    while (line_scanner_next(&sc, &line, &len, &offset)) {
+        ParsedRecord rec;
+        
+        // This Checks if this is the student we're looking for
+        if (parse_record_line(line, len, &rec) == PARSE_RECORD && rec.roll == roll) {
+            found = 1;
+            printf("Found at line %zu:\n", sc.line_num);
+            printf("Roll: %-5d Name: %-30s Marks: %3d [%s]\n",
+                   rec.roll, rec.name, rec.marks,
+                   (rec.marks >= PASS_THRESHOLD) ? "PASS" : "FAIL");
+            break;
+        }
+
+        if (single) {
+            break;
+        }
+    }
+
+    line_scanner_close(&sc);
+    return found;
+}
+
+/* Searches for a specific student by roll number directly in the file */
+static ErrorCode search_in_file_locked(const char *filename, int roll) {
+    if (!filename) {
+        return ERR_INVALID_INPUT;
+    }
+
+    BinaryMap map;
+    ErrorCode map_err = binary_map_open(filename, &map);
+    if (map_err == ERR_FILE_IO) {
+        return ERR_FILE_IO;
+    } else if (map_err == SUCCESS) {
+        printf("\nSearching for roll number %d in file: %s\n", roll, filename);
+        printf("---------------------------------------------------------------------------\n");
+
+        int found = search_binary_records(&map, roll);
+        binary_map_close(&map);
+
+        if (!found) {
+            printf("Student with roll number %d not found in the file.\n", roll);
+        }
+        printf("-------------------------------------------------------------------------------\n");
+        return found ? SUCCESS : ERR_NOT_FOUND;
+    }
+    
+    int fd = open_for_reading(filename);
+    if (fd < 0) {
+        return ERR_FILE_IO;
+    }
+
+    size_t indexed_line = 0;
+    off_t indexed_offset = 0;
+    int indexed = sidecar_lookup(filename, roll, &indexed_line, &indexed_offset);
+    int found = 0;
+    
+    printf("\nSearching for roll number %d in file: %s\n", roll, filename);
+    printf("---------------------------------------------------------------------------\n");
+
+    // With a usable index we read just the student's line (or skip the scan on a miss). If
+    // that line holds another roll, the file was edited in a way the stamps didn't catch,
+    // so the whole file is scanned after all
+    if (indexed == 1) {
+        found = search_scan(fd, roll, indexed_offset, indexed_line - 1, 1);
+    }
+    if (indexed == -1 || (indexed == 1 && found == 0)) {
+        found = search_scan(fd, roll, 0, 0, 0);
+    }
+
+    close(fd);
+    if (found < 0) {
+        return ERR_MEMORY;
+    }
+    
+    if (!found) {
+        printf("Student with roll number %d not found in the file.\n", roll);
+    }
+    printf("-------------------------------------------------------------------------------\n");
+    
+    return found ? SUCCESS : ERR_NOT_FOUND;
+}
+
+/* Under the shared lock the .idx sidecar and the data file it points into belong together */
+static ErrorCode search_in_file(const char *filename, int roll) {
+    if (!filename) {
+        return ERR_INVALID_INPUT;
+    }
+
+    FileLock lock;
+    if (file_lock(filename, 0, &lock) != SUCCESS) {
+        return ERR_MEMORY;
+    }
+
+    ErrorCode err = search_in_file_locked(filename, roll);
+    file_unlock(&lock);
+    return err;
+}
+
+static void summary_init(MarksSummary *sum) {
+    sum->count = 0;
+    sum->total = 0;
+    sum->min = MAX_MARKS;
+    sum->max = 0;
+    sum->pass = 0;
+    sum->fail = 0;
+}
+
+static void summary_add(MarksSummary *sum, int marks) {
+    sum->count++;
+    sum->total += marks;
+    
+    if (marks >= PASS_THRESHOLD) {
+        sum->pass++;
+    } else {
+        sum->fail++;
+    }
+    
+    if (marks < sum->min) {
+        sum->min = marks;
+    }
+    
+    if (marks > sum->max) {
+        sum->max = marks;
+    }
+}
+
+static void print_file_summary(const MarksSummary *sum) {
+    if (sum->count == 0) {
+        printf("\nNo valid student records found in the file.\n");
+        return;
+    }
+    
+    double avg = (double)sum->total / sum->count;
+    double pass_rate = (double)sum->pass / sum->count * 100;
+    
+    printf("----------------------------------------------------------------------------\n");
+    printf("Statistics Summary (from file)\n");
+    printf("-----------------------------------------------------------------------------\n");
+    printf("Total Students:    %zu\n", sum->count);
+    printf("Average Marks:     %.2f\n", avg);
+    printf("Highest Marks:     %d\n", sum->max);
+    printf("Lowest Marks:      %d\n", sum->min);
+    printf("Pass Count:        %d (%.1f%%)\n", sum->pass, pass_rate);
+    printf("Fail Count:        %d\n", sum->fail);
+    printf("-----------------------------------------------------------------------------\n");
+}
+
+static void summary_merge(MarksSummary *into, const MarksSummary *part) {
+    if (part->count == 0) {
+        return;
+    }
+
+    into->count += part->count;
+    into->total += part->total;
+    into->pass += part->pass;
+    into->fail += part->fail;
+
+    if (part->min < into->min) {
+        into->min = part->min;
+    }
+
+    if (part->max > into->max) {
+        into->max = part->max;
+    }
+}
+
+/* Parses every record in one chunk's byte range into its own summary */
+static void *statistics_worker(void *arg) {
+    StatsChunk *chunk = arg;
+    LineScanner sc;
+
+    summary_init(&chunk->sum);
+    chunk->err = line_scanner_open(&sc, chunk->fd, chunk->start, chunk->end);
+    if (chunk->err != SUCCESS) {
+        return NULL;
+    }
+
+    char *line;
+    size_t len;
+    off_t offset;
+
+    while (line_scanner_next(&sc, &line, &len, &offset)) {
+        ParsedRecord rec;
+
+        if (parse_record_line(line, len, &rec) == PARSE_RECORD) {
+            summary_add(&chunk->sum, rec.marks);
+        }
+    }
+
+    line_scanner_close(&sc);
+    return NULL;
+}
+
+/* Offset of the first line that starts at or after from (size if there is none) */
+static off_t next_line_start(int fd, off_t from, off_t size) {
+    char buf[4096];
+    off_t pos = from - 1;  // A newline just before from means a line starts exactly at from
+
+    while (pos < size) {
+        ssize_t n = pread(fd, buf, sizeof(buf), pos);
+        if (n <= 0) {
+            break;
+        }
+
+        const char *nl = find_byte(buf, buf + n, '\n');
+        if (nl) {
+            return pos + (nl - buf) + 1;
+        }
+        pos += n;
+    }
+
+    return size;
+}
+
+/* Splits a text file into one newline-aligned byte range per thread and merges the
+   per-thread summaries. Every range starts at a line start, so each line is seen
+   whole by exactly one thread and the totals match a single serial pass */
+static ErrorCode summarize_text_file(int fd, int threads, MarksSummary *sum) {
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        return ERR_FILE_IO;
+    }
+
+    // Small files aren't worth a thread per chunk
+    off_t chunks_by_size = st.st_size / PARALLEL_SCAN_MIN_CHUNK;
+    if (threads > chunks_by_size) {
+        threads = chunks_by_size > 1 ? (int)chunks_by_size : 1;
+    }
+
+    StatsChunk chunks[MAX_SCAN_THREADS];
+    pthread_t tids[MAX_SCAN_THREADS];
+    int started[MAX_SCAN_THREADS];
+    off_t start = 0;
+
+    for (int i = 0; i < threads; i++) {
+        off_t end = (i == threads - 1) ? st.st_size
+                                       : next_line_start(fd, st.st_size / threads * (i + 1), st.st_size);
+        if (end < start) {
+            end = start;
+        }
+
+        chunks[i].fd = fd;
+        chunks[i].start = start;
+        chunks[i].end = end;
+        start = end;
+    }
+
+    // The calling thread takes the first chunk itself; any thread that can't be started
+    // has its chunk run here too
+    for (int i = 1; i < threads; i++) {
+        started[i] = (pthread_create(&tids[i], NULL, statistics_worker, &chunks[i]) == 0);
+    }
+
+    statistics_worker(&chunks[0]);
+
+    for (int i = 1; i < threads; i++) {
+        if (started[i]) {
+            pthread_join(tids[i], NULL);
+        } else {
+            statistics_worker(&chunks[i]);
+        }
+    }
+
+    ErrorCode err = SUCCESS;
+    for (int i = 0; i < threads; i++) {
+        if (chunks[i].err != SUCCESS) {
+            err = chunks[i].err;
+        }
+        summary_merge(sum, &chunks[i].sum);
+    }
+
+    return err;
+}
+
+/* Calculates statistics by reading all records from file and aggregating data */
+static ErrorCode statistics_from_file_locked(const char *filename, int threads) {
+    if (!filename) {
+        return ERR_INVALID_INPUT;
+    }
+
+    MarksSummary sum;
+    summary_init(&sum);
+
+    BinaryMap map;
+    ErrorCode map_err = binary_map_open(filename, &map);
+    if (map_err == ERR_FILE_IO) {
+        return ERR_FILE_IO;
+    } else if (map_err == SUCCESS) {
+        printf("\nCalculating statistics from file: %s\n", filename);
+
+        // Only rows the loader would accept count, name included
+        for (uint64_t i = 0; i < map.header->record_count; i++) {
+            const BinaryRow *row = &map.rows[i];
+            size_t len;
+
+            if (binary_row_name(&map, row, &len) && row->roll > 0 && row->marks <= MAX_MARKS) {
+                summary_add(&sum, row->marks);
+            }
+        }
+
+        binary_map_close(&map);
+        print_file_summary(&sum);
+        return SUCCESS;
+    }
+    
+    int fd = open_for_reading(filename);
+    if (fd < 0) {
+        return ERR_FILE_IO;
+    }
+
+    ErrorCode err = summarize_text_file(fd, threads, &sum);
+    close(fd);
+
+    if (err != SUCCESS) {
+        return err;
+    }
+    
+    printf("\nCalculating statistics from file: %s\n", filename);
+    print_file_summary(&sum);
+    
+    return SUCCESS;
+}
+
+static ErrorCode statistics_from_file(const char *filename, int threads) {
+    if (!filename) {
+        return ERR_INVALID_INPUT;
+    }
+
+    FileLock lock;
+    if (file_lock(filename, 0, &lock) != SUCCESS) {
+        return ERR_MEMORY;
+    }
+
+    ErrorCode err = statistics_from_file_locked(filename, threads);
+    file_unlock(&lock);
+    return err;
+}
+
+static void rank_slots_free(RankSlots *rs) {
+    if (rs->slots) {
+        for (size_t i = 0; i < rs->used; i++) {
+            free(rs->slots[i].name);
+        }
+    }
+    free(rs->slots);
+    free(rs->name_caps);
+    rs->slots = NULL;
+    rs->name_caps = NULL;
+}
+
+static ErrorCode rank_slots_init(RankSlots *rs, size_t k) {
+    rs->slots = calloc(k + 1, sizeof(Student));
+    rs->name_caps = calloc(k + 1, sizeof(size_t));
+    rs->used = 1;
+    rs->spare = rs->slots;
+
+    if (!rs->slots || !rs->name_caps) {
+        rank_slots_free(rs);
+        return ERR_MEMORY;
+    }
+
+    return SUCCESS;
+}
+
+/* Copies one file record into the spare slot and offers it to the heap; whichever student
+   comes back becomes the next spare, so only K + 1 names are ever held */
+static ErrorCode rank_file_record(RankHeap *h, RankSlots *rs, int roll, int marks,
+                                  const char *name, size_t len) {
+    if (!rank_heap_wants_marks(h, marks)) {
+        return SUCCESS;
+    }
+
+    Student *slot = rs->spare;
+    size_t *cap = &rs->name_caps[slot - rs->slots];
+
+    if (*cap < len + 1) {
+        char *grown = realloc(slot->name, len + 1);
+        if (!grown) {
+            return ERR_MEMORY;
+        }
+        slot->name = grown;
+        *cap = len + 1;
+    }
+
+    memcpy(slot->name, name, len);
+    slot->name[len] = '\0';
+    slot->roll = roll;
+    slot->marks = marks;
+
+    Student *out = rank_heap_offer(h, slot);
+    rs->spare = out ? out : &rs->slots[rs->used++];
+    return SUCCESS;
+}
+
+/* Finds the k best (top) or worst (bottom) students in one pass over the file, holding
+   only K records in memory */
+static ErrorCode top_k_from_file_locked(const char *filename, size_t k, int top,
+                                        CollationMode collation) {
+    if (!filename || k == 0) {
+        return ERR_INVALID_INPUT;
+    }
+
+    RankHeap heap;
+    RankSlots slots;
+    if (rank_heap_init(&heap, k, top, collation) != SUCCESS) {
+        return ERR_MEMORY;
+    }
+    if (rank_slots_init(&slots, k) != SUCCESS) {
+        rank_heap_free(&heap);
+        return ERR_MEMORY;
+    }
+
+    ErrorCode err = SUCCESS;
+    BinaryMap map;
+    ErrorCode map_err = binary_map_open(filename, &map);
+
+    if (map_err == ERR_FILE_IO) {
+        err = ERR_FILE_IO;
+    } else if (map_err == SUCCESS) {
+        for (uint64_t i = 0; i < map.header->record_count && err == SUCCESS; i++) {
+            const BinaryRow *row = &map.rows[i];
+            size_t len;
+            const char *name = binary_row_name(&map, row, &len);
+
+            if (name && row->roll > 0 && row->marks <= MAX_MARKS) {
+                err = rank_file_record(&heap, &slots, row->roll, row->marks, name, len);
+            }
+        }
+
+        binary_map_close(&map);
+    } else {
+        int fd = open_for_reading(filename);
+        LineScanner sc;
+
+        if (fd < 0) {
+            err = ERR_FILE_IO;
+        } else if (line_scanner_open(&sc, fd, 0, -1) != SUCCESS) {
+            close(fd);
+            err = ERR_MEMORY;
+        } else {
+            char *line;
+            size_t len;
+            off_t offset;
+
+            while (err == SUCCESS && line_scanner_next(&sc, &line, &len, &offset)) {
+                ParsedRecord rec;
+
+                if (parse_record_line(line, len, &rec) == PARSE_RECORD) {
+                    err = rank_file_record(&heap, &slots, rec.roll, rec.marks, rec.name, rec.name_len);
+                }
+            }
+
+            line_scanner_close(&sc);
+            close(fd);
+        }
+    }
+
+    if (err == SUCCESS) {
+        printf("\nReading from file: %s\n", filename);
+        if (heap.size == 0) {
+            printf("No student records found in the file.\n");
+        } else {
+            rank_heap_sort(&heap);
+            display_ranked(&heap);
+        }
+    }
+
+    rank_slots_free(&slots);
+    rank_heap_free(&heap);
+    return err;
+}
+
+static ErrorCode top_k_from_file(const char *filename, size_t k, int top, CollationMode collation) {
+    if (!filename || k == 0) {
+        return ERR_INVALID_INPUT;
+    }
+
+    FileLock lock;
+    if (file_lock(filename, 0, &lock) != SUCCESS) {
+        return ERR_MEMORY;
+    }
+
+    ErrorCode err = top_k_from_file_locked(filename, k, top, collation);
+    file_unlock(&lock);
+    return err;
+}
+
+/* ---------- Search & Sort ---------- */
+
+static Student *search_by_roll(const StudentList *list, int roll) {
+    long idx = find_index_by_roll(list, roll);
+    return (idx >= 0) ? list->items[idx] : NULL;
+}
+
+static int cmp_marks_asc(const void *a, const void *b) {
+    const Student *sa = *(const Student**)a;
+    const Student *sb = *(const Student**)b;
+    return sa->marks - sb->marks;
+}
+
+static int cmp_marks_desc(const void *a, const void *b) {
+    return -cmp_marks_asc(a, b);
+}
+
+static int cmp_name_asc(const void *a, const void *b) {
+    const Student *sa = *(const Student**)a;
+    const Student *sb = *(const Student**)b;
+    return strcmp(sa->name, sb->name);
+}
+
+/* Marks only go from 0 to MAX_MARKS, so ordering by marks is a stable counting sort:
+   one pass to count, one pass to scatter src into dst. Students with equal marks keep
+   their order from src */
+static void counting_sort_by_marks(Student **src, Student **dst, size_t n) {
+    size_t start[MAX_MARKS + 1];
+    size_t count[MAX_MARKS + 1] = {0};
+
+    for (size_t i = 0; i < n; i++) {
+        count[src[i]->marks]++;
+    }
+
+    size_t pos = 0;
+    for (int m = 0; m <= MAX_MARKS; m++) {
+        start[m] = pos;
+        pos += count[m];
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        dst[start[src[i]->marks]++] = src[i];
+    }
+}
+
+/* Length of name's collation key, not counting the terminator */
+static size_t collation_key_length(const char *name, CollationMode mode) {
+    return (mode == COLLATE_LOCALE) ? strxfrm(NULL, name, 0) : strlen(name);
+}
+
+static void collation_key_build(const char *name, CollationMode mode, char *out, size_t size) {
+    if (mode == COLLATE_LOCALE) {
+        strxfrm(out, name, size);
+        return;
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        out[i] = (mode == COLLATE_NOCASE) ? (char)tolower((unsigned char)name[i]) : name[i];
+    }
+}
+
+static uint64_t name_key_prefix(const char *key) {
+    uint64_t prefix = 0;
+    int i = 0;
+
+    for (; i < 8 && key[i]; i++) {
+        prefix = (prefix << 8) | (unsigned char)key[i];
+    }
+
+    return prefix << (8 * (8 - i));  // Short keys pad with zero bytes, exactly like strcmp
+}
+
+static int cmp_name_key(const void *a, const void *b) {
+    const NameSortKey *ka = a;
+    const NameSortKey *kb = b;
+    int c = strcmp(ka->key, kb->key);
+
+    if (c == 0) {
+        c = (ka->student->roll > kb->student->roll) - (ka->student->roll < kb->student->roll);
+    }
+
+    return c;
+}
+
+/* LSD radix sort on the 8-byte prefixes, one stable pass per byte (passes where every key
+   has the same byte are skipped). Only runs of equal prefixes still need a full compare */
+static void radix_sort_name_keys(NameSortKey *keys, NameSortKey *scratch, size_t n) {
+    size_t counts[8][256];
+    memset(counts, 0, sizeof(counts));
+
+    for (size_t i = 0; i < n; i++) {
+        for (int byte = 0; byte < 8; byte++) {
+            counts[byte][(keys[i].prefix >> (8 * byte)) & 0xFF]++;
+        }
+    }
+
+    NameSortKey *src = keys;
+    NameSortKey *dst = scratch;
+
+    for (int byte = 0; byte < 8; byte++) {
+        size_t *count = counts[byte];
+        size_t start[256];
+        size_t pos = 0;
+
+        if (count[(src[0].prefix >> (8 * byte)) & 0xFF] == n) {
+            continue;
+        }
+
+        for (int b = 0; b < 256; b++) {
+            start[b] = pos;
+            pos += count[b];
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            dst[start[(src[i].prefix >> (8 * byte)) & 0xFF]++] = src[i];
+        }
+
+        NameSortKey *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    if (src != keys) {
+        memcpy(keys, src, n * sizeof(NameSortKey));
+    }
+
+    for (size_t i = 0; i < n; ) {
+        size_t j = i + 1;
+        while (j < n && keys[j].prefix == keys[i].prefix) {
+            j++;
+        }
+
+        if (j - i > 1) {
+            qsort(keys + i, j - i, sizeof(NameSortKey), cmp_name_key);
+        }
+        i = j;
+    }
+}
+
+/* Orders items by name under mode, equal names by roll. Collation keys (lower-cased or
+   strxfrm'd names) are built once per student up front, never inside a comparison */
+static ErrorCode sort_by_name_keys(Student **items, size_t n, CollationMode mode) {
+    if (n < 2) {
+        return SUCCESS;
+    }
+
+    NameSortKey *keys = malloc(n * sizeof(NameSortKey));
+    NameSortKey *scratch = malloc(n * sizeof(NameSortKey));
+    size_t *lengths = NULL;
+    char *key_text = NULL;
+    ErrorCode err = (keys && scratch) ? SUCCESS : ERR_MEMORY;
+
+    // Byte order compares the names themselves; the other modes need their own key text
+    if (err == SUCCESS && mode != COLLATE_BYTES) {
+        size_t total = 0;
+        lengths = malloc(n * sizeof(size_t));
+
+        if (lengths) {
+            for (size_t i = 0; i < n; i++) {
+                lengths[i] = collation_key_length(items[i]->name, mode) + 1;
+                total += lengths[i];
+            }
+            key_text = malloc(total);
+        }
+
+        if (!key_text) {
+            err = ERR_MEMORY;
+        }
+    }
+
+    if (err == SUCCESS) {
+        char *next = key_text;
+
+        for (size_t i = 0; i < n; i++) {
+            Student *s = items[i];
+            const char *key = s->name;
+
+            if (mode != COLLATE_BYTES) {
+                collation_key_build(s->name, mode, next, lengths[i]);
+                key = next;
+                next += lengths[i];
+            }
+
+            keys[i].prefix = name_key_prefix(key);
+            keys[i].key = key;
+            keys[i].student = s;
+        }
+
+        radix_sort_name_keys(keys, scratch, n);
+
+        for (size_t i = 0; i < n; i++) {
+            items[i] = keys[i].student;
+        }
+    }
+
+    free(keys);
+    free(scratch);
+    free(lengths);
+    free(key_text);
+    return err;
+}
+
+static StudentView view_for_comparator(int (*cmp)(const void*, const void*)) {
+    if (cmp == cmp_marks_asc) {
+        return VIEW_MARKS_ASC;
+    }
+    return (cmp == cmp_marks_desc) ? VIEW_MARKS_DESC : VIEW_NAME;
+}
+
+/* Reorders items itself. For the three menu orders this copies the matching sorted view,
+   so the saved file comes out exactly as options 7, 8 and 9 display it */
+static void sort_students(StudentList *list, int (*cmp)(const void*, const void*)) {
+    if (!list || list->size < 2) {
+        return;
+    }
+
+    int has_view = (cmp == cmp_marks_asc || cmp == cmp_marks_desc || cmp == cmp_name_asc);
+
+    if (has_view && views_build(list) == SUCCESS) {
+        view_walk(list, view_for_comparator(cmp), view_store, list->items);
+    } else {
+        qsort(list->items, list->size, sizeof(Student*), cmp);
+    }
+
+    refresh_columns(list);
+    roll_index_rebuild(list);
+    store_reset(list);  // The file should come out in the new order, so it is rewritten in full
+    list->modified = 1;  // Mark as modified since order changed
+}
+
+/* Ranking for top/bottom-K: best marks first (highest for top, lowest for bottom), then
+   name, then roll, the same tie order as the sorted views */
+static int rank_compare(const RankHeap *h, const Student *a, const Student *b) {
+    if (a->marks != b->marks) {
+        return h->top ? b->marks - a->marks : a->marks - b->marks;
+    }
+
+    int c = collate_compare(a->name, b->name, h->collation);
+    if (c != 0) {
+        return c;
+    }
+
+    return (a->roll > b->roll) - (a->roll < b->roll);
+}
+
+static ErrorCode rank_heap_init(RankHeap *h, size_t k, int top, CollationMode collation) {
+    h->items = malloc(k * sizeof(Student*));
+    h->size = 0;
+    h->capacity = k;
+    h->top = top;
+    h->collation = collation;
+    return h->items ? SUCCESS : ERR_MEMORY;
+}
+
+static void rank_heap_free(RankHeap *h) {
+    free(h->items);
+    h->items = NULL;
+    h->size = 0;
+}
+
+static void rank_heap_sift_down(RankHeap *h, size_t i) {
+    while (1) {
+        size_t worst = i;
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+
+        if (left < h->size && rank_compare(h, h->items[left], h->items[worst]) > 0) {
+            worst = left;
+        }
+        if (right < h->size && rank_compare(h, h->items[right], h->items[worst]) > 0) {
+            worst = right;
+        }
+        if (worst == i) {
+            return;
+        }
+
+        Student *tmp = h->items[i];
+        h->items[i] = h->items[worst];
+        h->items[worst] = tmp;
+        i = worst;
+    }
+}
+
+/* Offers s to the heap. Returns the student that did not make the cut (s itself or the one
+   it displaced), or NULL if there was still room */
+static Student *rank_heap_offer(RankHeap *h, Student *s) {
+    if (h->size < h->capacity) {
+        size_t i = h->size++;
+        h->items[i] = s;
+
+        while (i > 0) {
+            size_t parent = (i - 1) / 2;
+            if (rank_compare(h, h->items[i], h->items[parent]) <= 0) {
+                break;
+            }
+            Student *tmp = h->items[i];
+            h->items[i] = h->items[parent];
+            h->items[parent] = tmp;
+            i = parent;
+        }
+        return NULL;
+    }
+
+    if (rank_compare(h, s, h->items[0]) >= 0) {
+        return s;
+    }
+
+    Student *out = h->items[0];
+    h->items[0] = s;
+    rank_heap_sift_down(h, 0);
+    return out;
+}
+
+/* Whether a student with these marks could still make the cut, without looking at names */
+static int rank_heap_wants_marks(const RankHeap *h, int marks) {
+    if (h->size < h->capacity) {
+        return 1;
+    }
+
+    int worst = h->items[0]->marks;
+    return h->top ? marks >= worst : marks <= worst;
+}
+
+/* Heapsort in place, leaving items best-ranked first */
+static void rank_heap_sort(RankHeap *h) {
+    size_t n = h->size;
+
+    while (h->size > 1) {
+        Student *tmp = h->items[0];
+        h->items[0] = h->items[h->size - 1];
+        h->items[h->size - 1] = tmp;
+        h->size--;
+        rank_heap_sift_down(h, 0);
+    }
+
+    h->size = n;
+}
+
+static void display_ranked(const RankHeap *h) {
+    printf("\n%s %zu students by marks\n", h->top ? "Top" : "Bottom", h->size);
+    printf("----------------------------------------------------------------------------\n");
+    for (size_t i = 0; i < h->size; i++) {
+        printf("[%zu] ", i + 1);
+        display_student(h->items[i]);
+    }
+    printf("------------------------------------------------------------------------------\n");
+}
+
+/* Shows the k best (top) or worst (bottom) students without sorting the list. The marks
+   histogram gives the boundary mark up front, so one pass over the marks column sends only
+   students at or past it through a K-sized heap */
+static ErrorCode display_top_k(const StudentList *list, size_t k, int top) {
+    if (!list || list->size == 0) {
+        printf("\nNo students in the system.\n");
+        return SUCCESS;
+    }
+
+    if (k > list->size) {
+        k = list->size;
+    }
+
+    int boundary = top ? MAX_MARKS : 0;
+    size_t seen = 0;
+
+    for (int i = 0; i <= MAX_MARKS && seen < k; i++) {
+        boundary = top ? MAX_MARKS - i : i;
+        seen += list->marks_hist[boundary];
+    }
+
+    RankHeap heap;
+    if (rank_heap_init(&heap, k, top, list->collation) != SUCCESS) {
+        return ERR_MEMORY;
+    }
+
+    for (size_t i = 0; i < list->size; i++) {
+        int m = list->marks[i];
+
+        if (top ? m >= boundary : m <= boundary) {
+            rank_heap_offer(&heap, list->items[i]);
+        }
+    }
+
+    rank_heap_sort(&heap);
+    display_ranked(&heap);
+    rank_heap_free(&heap);
+
+    return SUCCESS;
+}
+
+/* ---------- Input Helpers(This code assissts with input cases and the rest) ---------- */
+
+static int prompt_yes_no(const char *prompt) {
+    while (1) {
+        char *line = read_line(prompt);
+
+        if (!line) {
+            continue;
+        }
+
+        trim_inplace(line);
+
+        if (strlen(line) > 0) {
+            char c = tolower((unsigned char)line[0]);
+            free(line);
+
+            if (c == 'y') {
+                return 1;
+            }
+
+            if (c == 'n') {
+                return 0;
+            }
+        } else {
+            free(line);
+        }
+        printf("Please enter 'y' or 'n'.\n");
+    }
+}
+
+static void auto_save_prompt(StudentList *list) {
+    async_save_settle(list, 1);  // A failed background save shows up as unsaved changes
+
+    if (!list->modified) {
+        return;
+    }
+    
+    printf("\nYou have unsaved changes!\n");
+    
+    if (list->last_filename) {
+        printf("Last file: %s\n", list->last_filename);
+
+        if (prompt_yes_no("Save to this file? (y/n): ")) {
+            if (save_to_file(list, list->last_filename) == SUCCESS) {
+                printf("Saved %zu records to '%s'\n", list->size, list->last_filename);
+            }
+        }
+    } else {
+        if (prompt_yes_no("Would you like to save to " FILENAME "? (y/n): ")) {
+            if (save_to_file(list, FILENAME) == SUCCESS) {
+                printf("Saved %zu records to '" FILENAME "'\n", list->size);
+            }
+        }
+    }
+}
+
+static int prompt_int(const char *prompt, int min, int max) {
+    while (1) {
+        char *line = read_line(prompt);
+
+        if (!line) {
+            printf("Memory error. Try again.\n");
+            continue;
+        }
+        
+        trim_inplace(line);
+
+        if (strlen(line) == 0) {
+            free(line);
+            printf("Input cannot be empty. Try again.\n");
+            continue;
+        }
+        
+        char *endptr = NULL;
+        errno = 0;
+        long val = strtol(line, &endptr, 10);
+        
+        if (*endptr != '\0' || errno == ERANGE) {
+            free(line);
+            printf("Invalid number. Try again.\n");
+            continue;
+        }
+        
+        free(line);
+        
+        if (val < min || val > max) {
+            printf("Number must be between %d and %d. Try again.\n", min, max);
+            continue;
+        }
+        
+        return (int)val;
+    }
+}
+
+static ErrorCode prompt_student_input(int *out_roll, char **out_name, int *out_marks) {
+    int roll = prompt_int("Enter roll number (1-99999): ", MIN_ROLL, MAX_ROLL);
+    
+    char *line = read_line("Enter student name: ");
+
+    if (!line) {
+        return ERR_MEMORY;
+    }
+
+    trim_inplace(line);
+
+    if (strlen(line) == 0) {
+        free(line);
+        line = safe_strdup("Unnamed");
+    } else if (strlen(line) > MAX_NAME_LENGTH) {
+        line[MAX_NAME_LENGTH] = '\0';
+        printf("Name truncated to %d characters.\n", MAX_NAME_LENGTH);
+    }
+    
+    int marks = prompt_int("Enter marks (0-100): ", 0, 100);
+    
+    *out_roll = roll;
+    *out_name = line;
+    *out_marks = marks;
+    
+    return SUCCESS;
+}
+
+/* ---------- Menu System ---------- */
+
+static void show_menu(void) {
+    printf("\n");
+    printf("┌────────────────────────────────────────┐\n");
+    printf("│     Student Record System Menu         │\n");
+    printf("├────────────────────────────────────────┤\n");
+    printf("│  1. Add a student                      │\n");
+    printf("│  2. Modify a student                   │\n");
+    printf("│  3. Remove a student                   │\n");
+    printf("│  4. Display all students               │\n");
+    printf("│  5. Search by roll number              │\n");
+    printf("│  6. Show statistics                    │\n");
+    printf("│  7. Sort by marks (ascending)          │\n");
+    printf("│  8. Sort by marks (descending)         │\n");
+    printf("│  9. Sort by name                       │\n");
+    printf("│ 10. Save to file                       │\n");
+    printf("│ 11. Load from file                     │\n");
+    printf("│ 12. Quick save                         │\n");
+    printf("│ 13. Top / bottom students              │\n");
+    printf("│ 14. Import records from a file         │\n");
+    printf("│  0. Exit                               │\n");
+    printf("└────────────────────────────────────────┘\n");
+}
+
+/* ---------- Batch Mode ---------- */
+
+/* Recomputes everything the list keeps up to date incrementally (dense columns, roll index,
+   mark counters, sorted views) and compares. Returns NULL when it all agrees, else what
+   doesn't. Only reads the list */
+static const char *list_check(const StudentList *list) {
+    size_t hist[MAX_MARKS + 1] = {0};
+    long total = 0;
+    size_t passed = 0;
+
+    for (size_t i = 0; i < list->size; i++) {
+        const Student *s = list->items[i];
+
+        if (s->marks < 0 || s->marks > MAX_MARKS) {
+            return "marks out of range";
+        }
+        if (list->rolls[i] != s->roll || list->marks[i] != s->marks) {
+            return "dense columns differ from the records";
+        }
+        if (find_index_by_roll(list, s->roll) != (long)i) {
+            return "roll index points at the wrong record";
+        }
+
+        hist[s->marks]++;
+        total += s->marks;
+        passed += (s->marks >= PASS_THRESHOLD);
+    }
+
+    if (list->index.count != list->size) {
+        return "roll index holds stale entries";
+    }
+    if (memcmp(hist, list->marks_hist, sizeof(hist)) != 0 || total != list->marks_total ||
+        passed != list->pass_count) {
+        return "mark counters are out of date";
+    }
+
+    if (!list->views_valid) {
+        return NULL;
+    }
+
+    // Strictly increasing, and every entry found through the index, means each view is
+    // exactly the records in order
+    for (size_t i = 0; i < list->size; i++) {
+        const Student *a = list->by_name[i];
+        const Student *b = list->by_marks[i];
+        long ia = find_index_by_roll(list, a->roll);
+        long ib = find_index_by_roll(list, b->roll);
+
+        if (ia < 0 || ib < 0 || list->items[ia] != a || list->items[ib] != b) {
+            return "a sorted view holds a removed record";
+        }
+        if (i > 0 && (view_compare(list, 0, list->by_name[i - 1], a) >= 0 ||
+                      view_compare(list, 1, list->by_marks[i - 1], b) >= 0)) {
+            return "a sorted view is out of order";
+        }
+    }
+
+    return NULL;
+}
+
+/* Reads one integer field of a batch command and moves *cursor past it */
+static int batch_int(char **cursor, int min, int max, int *out) {
+    char *p = *cursor;
+    while (*p == ' ' || *p == '\t') {
+        p++;
+    }
+
+    char *end;
+    errno = 0;
+    long value = strtol(p, &end, 10);
+
+    if (end == p || errno != 0 || value < min || value > max ||
+        (*end != '\0' && *end != ' ' && *end != '\t')) {
+        return 0;
+    }
+
+    *out = (int)value;
+    *cursor = end;
+    return 1;
+}
+
+static void batch_print_student(FILE *out, const Student *s) {
+    fprintf(out, "Roll: %-5d Name: %-30s Marks: %3d [%s]\n", s->roll, s->name, s->marks,
+            (s->marks >= PASS_THRESHOLD) ? "PASS" : "FAIL");
+}
+
+static void batch_list_visit(Student *s, size_t pos, void *ctx) {
+    (void)pos;
+    batch_print_student(ctx, s);
+}
+
+/* The rest of the line as a name: trimmed, "Unnamed" if empty, cut at MAX_NAME_LENGTH */
+static char *batch_name(char *cursor) {
+    trim_inplace(cursor);
+
+    if (*cursor == '\0') {
+        return "Unnamed";
+    }
+    if (strlen(cursor) > MAX_NAME_LENGTH) {
+        cursor[MAX_NAME_LENGTH] = '\0';
+    }
+    return cursor;
+}
+
+/* Runs one batch command against the list, writing any output to out. On failure *why
+   says what was wrong. Commands:
+     add ROLL MARKS NAME
+     mod ROLL NEW_ROLL MARKS NAME
+     del ROLL
+     find ROLL
+     list [marks|desc|name]
+     stats
+     import FILE [first|last|reject]
+   Blank lines and lines starting with # are ignored */
+static ErrorCode batch_execute(StudentList *list, char *line, FILE *out, const char **why) {
+    trim_inplace(line);
+    *why = NULL;
+
+    if (line[0] == '\0' || line[0] == '#') {
+        return SUCCESS;
+    }
+
+    char *cursor = line;
+    while (*cursor && *cursor != ' ' && *cursor != '\t') {
+        cursor++;
+    }
+
+    size_t cmd_len = (size_t)(cursor - line);
+    int roll, new_roll, marks;
+
+    if (cmd_len == 3 && strncmp(line, "add", 3) == 0) {
+        if (!batch_int(&cursor, MIN_ROLL, MAX_ROLL, &roll) ||
+            !batch_int(&cursor, 0, MAX_MARKS, &marks)) {
+            *why = "usage: add ROLL MARKS NAME";
+            return ERR_INVALID_INPUT;
+        }
+
+        Student *s = create_student(list, roll, batch_name(cursor), marks);
+        if (!s) {
+            *why = "out of memory";
+            return ERR_MEMORY;
+        }
+
+        ErrorCode err = add_student(list, s);
+        if (err != SUCCESS) {
+            free_student(list, s);
+            *why = (err == ERR_DUPLICATE) ? "roll number already exists" : "out of memory";
+        }
+        return err;
+    }
+
+    if (cmd_len == 3 && strncmp(line, "mod", 3) == 0) {
+        if (!batch_int(&cursor, MIN_ROLL, MAX_ROLL, &roll) ||
+            !batch_int(&cursor, MIN_ROLL, MAX_ROLL, &new_roll) ||
+            !batch_int(&cursor, 0, MAX_MARKS, &marks)) {
+            *why = "usage: mod ROLL NEW_ROLL MARKS NAME";
+            return ERR_INVALID_INPUT;
+        }
+
+        long idx = find_index_by_roll(list, roll);
+        if (idx < 0) {
+            *why = "no student with that roll number";
+            return ERR_NOT_FOUND;
+        }
+
+        ErrorCode err = modify_student(list, (size_t)idx, new_roll, batch_name(cursor), marks);
+        if (err != SUCCESS) {
+            *why = (err == ERR_DUPLICATE) ? "new roll number already exists" : "out of memory";
+        }
+        return err;
+    }
+
+    if ((cmd_len == 3 && strncmp(line, "del", 3) == 0) ||
+        (cmd_len == 4 && strncmp(line, "find", 4) == 0)) {
+        if (!batch_int(&cursor, MIN_ROLL, MAX_ROLL, &roll)) {
+            *why = "usage: del ROLL / find ROLL";
+            return ERR_INVALID_INPUT;
+        }
+
+        long idx = find_index_by_roll(list, roll);
+        if (idx < 0) {
+            *why = "no student with that roll number";
+            return ERR_NOT_FOUND;
+        }
+
+        if (line[0] == 'd') {
+            return remove_student_by_index(list, (size_t)idx);
+        }
+
+        batch_print_student(out, list->items[idx]);
+        return SUCCESS;
+    }
+
+    if (cmd_len == 4 && strncmp(line, "list", 4) == 0) {
+        char *save = NULL;
+        char *order = strtok_r(cursor, " \t", &save);
+        StudentView view;
+
+        if (!order) {
+            for (size_t i = 0; i < list->size; i++) {
+                batch_print_student(out, list->items[i]);
+            }
+            return SUCCESS;
+        }
+
+        if (strcmp(order, "marks") == 0) {
+            view = VIEW_MARKS_ASC;
+        } else if (strcmp(order, "desc") == 0) {
+            view = VIEW_MARKS_DESC;
+        } else if (strcmp(order, "name") == 0) {
+            view = VIEW_NAME;
+        } else {
+            *why = "usage: list [marks|desc|name]";
+            return ERR_INVALID_INPUT;
+        }
+
+        if (views_build(list) != SUCCESS) {
+            *why = "out of memory";
+            return ERR_MEMORY;
+        }
+        view_walk(list, view, batch_list_visit, out);
+        return SUCCESS;
+    }
+
+    if (cmd_len == 6 && strncmp(line, "import", 6) == 0) {
+        char *save = NULL;
+        char *source = strtok_r(cursor, " \t", &save);
+        char *mode = strtok_r(NULL, " \t", &save);
+        ImportPolicy policy = IMPORT_KEEP_FIRST;
+
+        if (mode && strcmp(mode, "last") == 0) {
+            policy = IMPORT_KEEP_LAST;
+        } else if (mode && strcmp(mode, "reject") == 0) {
+            policy = IMPORT_REJECT;
+        } else if (mode && strcmp(mode, "first") != 0) {
+            source = NULL;
+        }
+
+        if (!source || strtok_r(NULL, " \t", &save)) {
+            *why = "usage: import FILE [first|last|reject]";
+            return ERR_INVALID_INPUT;
+        }
+
+        ImportSummary summary;
+        ErrorCode err = import_from_file(list, source, policy, &summary);
+
+        if (err == SUCCESS) {
+            fprintf(out, "Imported %zu new and %zu replaced records from '%s'\n",
+                    summary.added, summary.replaced, source);
+        } else if (err == ERR_DUPLICATE) {
+            *why = "import cancelled because of duplicate roll numbers";
+        } else {
+            *why = (err == ERR_FILE_IO) ? "cannot read the import file" : "out of memory";
+        }
+        return err;
+    }
+
+    if (cmd_len == 5 && strncmp(line, "stats", 5) == 0) {
+        display_statistics(list, out);
+        return SUCCESS;
+    }
+
+    if (cmd_len == 5 && strncmp(line, "check", 5) == 0) {
+        *why = list_check(list);
+        if (*why) {
+            return ERR_INVALID_INPUT;
+        }
+        fprintf(out, "Consistent: %zu records\n", list->size);
+        return SUCCESS;
+    }
+
+    *why = "unknown command";
+    return ERR_INVALID_INPUT;
+}
+
+/* Loads the data file for batch and server mode. One that doesn't exist yet leaves the list
+   empty but still tied to it, so the first save won't overwrite a file another program
+   has created in the meantime */
+static ErrorCode open_data_file(StudentList *list, const char *filename) {
+    FileStamp stamp;
+
+    if (file_stamp_read(filename, &stamp) != SUCCESS) {
+        return remember_filename(list, filename);
+    }
+
+    return load_from_file(list, filename);
+}
+
+/* Applies every command from in to the data file's records and saves once at the end,
+   instead of once per change as the menu does */
+static int run_batch(StudentList *list, const char *path, const char *filename) {
+    FILE *in = (strcmp(path, "-") == 0) ? stdin : fopen(path, "r");
+    if (!in) {
+        fprintf(stderr, "Error: Cannot open '%s': %s\n", path, strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    if (open_data_file(list, filename) != SUCCESS) {
+        if (in != stdin) {
+            fclose(in);
+        }
+        return EXIT_FAILURE;
+    }
+
+    char *line = NULL;
+    size_t line_cap = 0;
+    size_t line_num = 0, commands = 0, failed = 0;
+
+    while (getline(&line, &line_cap, in) != -1) {
+        const char *why;
+
+        line_num++;
+        if (batch_execute(list, line, stdout, &why) != SUCCESS) {
+            fprintf(stderr, "Error: %s line %zu: %s\n", path, line_num, why ? why : "failed");
+            failed++;
+        }
+        commands++;
+    }
+
+    free(line);
+    if (in != stdin) {
+        fclose(in);
+    }
+
+    int status = failed ? EXIT_FAILURE : EXIT_SUCCESS;
+
+    if (list->modified) {
+        if (save_to_file(list, filename) != SUCCESS) {
+            return EXIT_FAILURE;
+        }
+        printf("Saved %zu records to '%s' (%llu bytes written, write %.1f ms, %s %.1f ms)\n",
+               list->size, filename, (unsigned long long)list->last_save.bytes,
+               list->last_save.write_ms, (list->save_mode == SAVE_DURABLE) ? "sync" : "no sync",
+               list->last_save.sync_ms);
+    }
+
+    printf("Batch finished: %zu lines, %zu failed\n", commands, failed);
+    return status;
+}
+
+/* ---------- Server Mode ---------- */
+
+/* student_records --serve loads the data file once and answers the batch commands for any
+   number of local clients over a Unix domain socket, one thread per connection. The
+   protocol is line based: the client sends one command per line, and the server answers
+   with the command's output lines followed by a status line, "OK" or "ERR reason".
+   Commands that only read the list (find, list, stats, check) share the server's lock and
+   run side by side; the others take it alone. Each command's output is collected in
+   memory and sent after the lock is released, so a slow client never holds up the rest.
+   Changes are persisted by the background saver. Handing it a snapshot copies the whole
+   list, so while a write is running further changes just stay marked as unsaved, and the
+   accept loop passes them on every SERVER_FLUSH_MS once the saver is free again */
+
+static volatile sig_atomic_t server_stopping = 0;
+
+static void server_stop_signal(int sig) {
+    (void)sig;
+    server_stopping = 1;
+}
+
+static void roster_lock_init(RosterLock *lock) {
+    pthread_rwlock_init(&lock->rw, NULL);
+    pthread_mutex_init(&lock->turnstile, NULL);
+}
+
+/* Passing through the turnstile waits out any writer already queued */
+static void roster_read_lock(RosterLock *lock) {
+    pthread_mutex_lock(&lock->turnstile);
+    pthread_mutex_unlock(&lock->turnstile);
+    pthread_rwlock_rdlock(&lock->rw);
+}
+
+static void roster_write_lock(RosterLock *lock) {
+    pthread_mutex_lock(&lock->turnstile);
+    pthread_rwlock_wrlock(&lock->rw);
+    pthread_mutex_unlock(&lock->turnstile);
+}
+
+static void roster_unlock(RosterLock *lock) {
+    pthread_rwlock_unlock(&lock->rw);
+}
+
+/* Whether a (trimmed) command only reads the list. A sorted listing also sets *needs_views:
+   it reads as long as the views are built, but building them writes */
+static int server_reads_only(const char *line, int *needs_views) {
+    size_t len = strcspn(line, " \t");
+
+    *needs_views = 0;
+    if (len == 4 && strncmp(line, "list", 4) == 0) {
+        *needs_views = (line[len] != '\0');
+        return 1;
+    }
+
+    return (len == 4 && strncmp(line, "find", 4) == 0) ||
+           (len == 5 && strncmp(line, "stats", 5) == 0) ||
+           (len == 5 && strncmp(line, "check", 5) == 0);
+}
+
+/* Called with the server lock held exclusively. "OK" therefore means the change is in memory and will be
+   on disk within one save (plus SERVER_FLUSH_MS); without a saver it is saved right away */
+static ErrorCode server_persist(RosterServer *server) {
+    StudentList *list = server->list;
+
+    if (!list->modified) {
+        return SUCCESS;
+    }
+    if (list->conflict) {
+        return ERR_CONFLICT;  // Only a restart (which reloads the file) clears this
+    }
+    if (!list->saver) {
+        return save_to_file(list, server->filename);
+    }
+    if (async_save_settle(list, 0)) {
+        return SUCCESS;  // A write is queued or running; the flush tick submits after it
+    }
+    if (list->conflict) {
+        return ERR_CONFLICT;
+    }
+
+    return async_save_submit(list, server->filename);
+}
+
+/* Runs one request and writes its reply (output, then status line) to out */
+static void server_handle(RosterServer *server, char *line, FILE *out) {
+    char *reply = NULL;
+    size_t reply_len = 0;
+    FILE *buffer = open_memstream(&reply, &reply_len);
+    const char *why = "out of memory";
+    ErrorCode err = ERR_MEMORY;
+
+    if (buffer) {
+        int needs_views;
+        int shared;
+
+        trim_inplace(line);
+        shared = server_reads_only(line, &needs_views);
+
+        if (shared) {
+            roster_read_lock(&server->lock);
+            if (needs_views && !server->list->views_valid) {
+                roster_unlock(&server->lock);
+                shared = 0;  // The first sorted listing builds the views; changes keep them current
+            }
+        }
+        if (!shared) {
+            roster_write_lock(&server->lock);
+        }
+
+        err = batch_execute(server->list, line, buffer, &why);
+
+        if (!shared && err == SUCCESS) {
+            err = server_persist(server);
+            if (err == ERR_CONFLICT) {
+                why = "the data file was changed by another program; restart the server to reload it";
+            } else if (err != SUCCESS) {
+                why = "the change could not be saved";
+            }
+        }
+        roster_unlock(&server->lock);
+        fclose(buffer);
+    }
+
+    if (reply_len > 0) {
+        fwrite(reply, 1, reply_len, out);
+    }
+    free(reply);
+
+    if (err == SUCCESS) {
+        fputs("OK\n", out);
+    } else {
+        fprintf(out, "ERR %s\n", why ? why : "failed");
+    }
+    fflush(out);
+}
+
+static void server_client_add(RosterServer *server, ServerClient *client) {
+    pthread_mutex_lock(&server->clients_lock);
+    client->prev = NULL;
+    client->next = server->clients;
+    if (server->clients) {
+        server->clients->prev = client;
+    }
+    server->clients = client;
+    server->client_count++;
+    pthread_mutex_unlock(&server->clients_lock);
+}
+
+/* Must happen before client->fd is closed, so a stop never shuts down a reused descriptor.
+   The client's thread doesn't touch the server afterwards */
+static void server_client_remove(ServerClient *client) {
+    RosterServer *server = client->server;
+
+    pthread_mutex_lock(&server->clients_lock);
+    if (client->prev) {
+        client->prev->next = client->next;
+    } else {
+        server->clients = client->next;
+    }
+    if (client->next) {
+        client->next->prev = client->prev;
+    }
+    if (--server->client_count == 0) {
+        pthread_cond_signal(&server->clients_done);
+    }
+    pthread_mutex_unlock(&server->clients_lock);
+}
+
+/* Hangs up on every client and waits for their threads. A command already running still
+   finishes; its reply just can't be delivered */
+static void server_drop_clients(RosterServer *server) {
+    pthread_mutex_lock(&server->clients_lock);
+    for (ServerClient *client = server->clients; client; client = client->next) {
+        shutdown(client->fd, SHUT_RDWR);
+    }
+    while (server->client_count > 0) {
+        pthread_cond_wait(&server->clients_done, &server->clients_lock);
+    }
+    pthread_mutex_unlock(&server->clients_lock);
+}
+
+static void *server_client_main(void *arg) {
+    ServerClient *client = arg;
+    int out_fd = dup(client->fd);
+    FILE *in = fdopen(client->fd, "r");
+    FILE *out = (out_fd >= 0) ? fdopen(out_fd, "w") : NULL;
+
+    if (in && out) {
+        char *line = NULL;
+        size_t line_cap = 0;
+
+        while (getline(&line, &line_cap, in) != -1 && !ferror(out)) {
+            server_handle(client->server, line, out);
+        }
+        free(line);
+    }
+
+    server_client_remove(client);
+
+    // fclose closes the descriptor underneath; whatever wasn't wrapped is closed directly
+    if (in) {
+        fclose(in);
+    } else {
+        close(client->fd);
+    }
+    if (out) {
+        fclose(out);
+    } else if (out_fd >= 0) {
+        close(out_fd);
+    }
+
+    free(client);
+    return NULL;
+}
+
+static int server_address(const char *socket_path, struct sockaddr_un *addr) {
+    if (strlen(socket_path) >= sizeof(addr->sun_path)) {
+        fprintf(stderr, "Error: Socket path '%s' is too long\n", socket_path);
+        return 0;
+    }
+
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    strcpy(addr->sun_path, socket_path);
+    return 1;
+}
+
+/* Serves until SIGINT or SIGTERM, then hangs up on the clients still connected, waits for
+   their threads and saves anything unsaved */
+static int run_server(StudentList *list, const char *filename, const char *socket_path) {
+    struct sockaddr_un addr;
+    if (!server_address(socket_path, &addr)) {
+        return EXIT_FAILURE;
+    }
+
+    if (open_data_file(list, filename) != SUCCESS) {
+        return EXIT_FAILURE;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot create socket: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    // A socket file nobody answers on is left over from a server that died; replace it
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+        fprintf(stderr, "Error: A server is already listening on '%s'\n", socket_path);
+        close(fd);
+        return EXIT_FAILURE;
+    }
+    close(fd);
+    unlink(socket_path);
+
+    // Only our own user may connect: commands like import read files with our permissions.
+    // bind() creates the socket file, so the mask is narrowed just around it
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    mode_t old_mask = umask(0077);
+    int bound = (fd >= 0 && bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+    umask(old_mask);
+
+    if (!bound || listen(fd, SOMAXCONN) != 0) {
+        fprintf(stderr, "Error: Cannot listen on '%s': %s\n", socket_path, strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+        }
+        return EXIT_FAILURE;
+    }
+
+    // No SA_RESTART, so a stop signal interrupts poll()
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sigemptyset(&sa.sa_mask);
+    sa.sa_handler = server_stop_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    sa.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &sa, NULL);  // A client that hangs up shows up as a write error
+
+    if (async_save_start(list) != SUCCESS) {
+        printf("Warning: Could not start the background saver; saving after every change.\n");
+    }
+
+    RosterServer server;
+    server.list = list;
+    server.filename = filename;
+    roster_lock_init(&server.lock);
+    pthread_mutex_init(&server.clients_lock, NULL);
+    pthread_cond_init(&server.clients_done, NULL);
+    server.clients = NULL;
+    server.client_count = 0;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+    printf("Serving %zu records from '%s' on '%s' (Ctrl+C to stop)\n",
+           list->size, filename, socket_path);
+    fflush(stdout);
+
+    struct timespec last_flush;
+    clock_gettime(CLOCK_MONOTONIC, &last_flush);
+
+    while (!server_stopping) {
+        struct pollfd listener = { .fd = fd, .events = POLLIN, .revents = 0 };
+        double until_flush = SERVER_FLUSH_MS - elapsed_ms(&last_flush);
+        int ready = poll(&listener, 1, until_flush > 0 ? (int)until_flush + 1 : 0);
+
+        // Checked on every pass, since with connections arriving steadily poll never times out
+        if (elapsed_ms(&last_flush) >= SERVER_FLUSH_MS) {
+            // A refused save was reported when it happened; retrying can't succeed
+            roster_write_lock(&server.lock);
+            if (!list->conflict && server_persist(&server) != SUCCESS && !list->conflict) {
+                fprintf(stderr, "Error: Could not save changes to '%s'\n", filename);
+            }
+            roster_unlock(&server.lock);
+            clock_gettime(CLOCK_MONOTONIC, &last_flush);
+        }
+
+        if (ready == 0) {
+            continue;
+        }
+
+        int conn = (ready > 0) ? accept(fd, NULL, NULL) : -1;
+
+        if (conn < 0) {
+            if (errno == EINTR || errno == ECONNABORTED || errno == EAGAIN) {
+                continue;
+            }
+            fprintf(stderr, "Error: accept failed: %s\n", strerror(errno));
+            break;
         }
-        
-        if (marks < min_marks) {
-            min_marks = marks;
+
+        ServerClient *client = malloc(sizeof(ServerClient));
+        pthread_t thread;
+
+        if (!client) {
+            close(conn);
+            continue;
         }
-        
-        if (marks > max_marks) {
-            max_marks = marks;
+        client->fd = conn;
+        client->server = &server;
+        server_client_add(&server, client);
+
+        if (pthread_create(&thread, &attr, server_client_main, client) != 0) {
+            server_client_remove(client);
+            close(conn);
+            free(client);
         }
     }
-    
-    fclose(f);
-    
-    if (count == 0) {
-        printf("\nNo valid student records found in the file.\n");
-        return SUCCESS;
-    }
-    
-    double avg = (double)total_marks / count;
-    double pass_rate = (double)pass_count / count * 100;
-    
-    printf("----------------------------------------------------------------------------\n");
-    printf("Statistics Summary (from file)\n");
-    printf("-----------------------------------------------------------------------------\n");
-    printf("Total Students:    %zu\n", count);
-    printf("Average Marks:     %.2f\n", avg);
-    printf("Highest Marks:     %d\n", max_marks);
-    printf("Lowest Marks:      %d\n", min_marks);
-    printf("Pass Count:        %d (%.1f%%)\n", pass_count, pass_rate);
-    printf("Fail Count:        %d\n", fail_count);
-    printf("-----------------------------------------------------------------------------\n");
-    
-    return SUCCESS;
-}
 
-/* ---------- Search & Sort ---------- */
+    pthread_attr_destroy(&attr);
+    close(fd);
+    unlink(socket_path);
 
-static Student *search_by_roll(const StudentList *list, int roll) {
-    long idx = find_index_by_roll(list, roll);
-    return (idx >= 0) ? list->items[idx] : NULL;
-}
+    // Once every client thread is gone nothing else refers to server or list, so they can
+    // go out of scope and be freed
+    printf("\nStopping server...\n");
+    fflush(stdout);
+    server_drop_clients(&server);
 
-static int cmp_marks_asc(const void *a, const void *b) {
-    const Student *sa = *(const Student**)a;
-    const Student *sb = *(const Student**)b;
-    return sa->marks - sb->marks;
-}
+    int status = EXIT_SUCCESS;
+    if (list->modified && save_to_file(list, filename) != SUCCESS) {
+        status = EXIT_FAILURE;
+    }
+    async_save_stop(list);
 
-static int cmp_marks_desc(const void *a, const void *b) {
-    return -cmp_marks_asc(a, b);
+    pthread_cond_destroy(&server.clients_done);
+    pthread_mutex_destroy(&server.clients_lock);
+    return status;
 }
 
-static int cmp_name_asc(const void *a, const void *b) {
-    const Student *sa = *(const Student**)a;
-    const Student *sb = *(const Student**)b;
-    return strcmp(sa->name, sb->name);
-}
+/* Sends each command line from stdin to the server and prints its replies; failures go
+   to stderr with their line number, like batch mode */
+static int run_client(const char *socket_path) {
+    struct sockaddr_un addr;
+    if (!server_address(socket_path, &addr)) {
+        return EXIT_FAILURE;
+    }
 
-static void sort_students(StudentList *list, int (*cmp)(const void*, const void*)) {
-    if (!list || list->size < 2) {
-        return;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        fprintf(stderr, "Error: Cannot connect to '%s': %s\n", socket_path, strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+        }
+        return EXIT_FAILURE;
     }
 
-    qsort(list->items, list->size, sizeof(Student*), cmp);
-    list->modified = 1;  // Mark as modified since order changed
-}
+    int out_fd = dup(fd);
+    FILE *from_server = fdopen(fd, "r");
+    FILE *to_server = (out_fd >= 0) ? fdopen(out_fd, "w") : NULL;
 
-/* ---------- Input Helpers(This code assissts with input cases and the rest) ---------- */
+    if (!from_server || !to_server) {
+        fprintf(stderr, "Error: Out of memory\n");
+        return EXIT_FAILURE;
+    }
 
-static int prompt_yes_no(const char *prompt) {
-    while (1) {
-        char *line = read_line(prompt);
+    char *line = NULL, *reply = NULL;
+    size_t line_cap = 0, reply_cap = 0;
+    size_t line_num = 0, failed = 0;
+    int status = EXIT_SUCCESS;
 
-        if (!line) {
+    while (getline(&line, &line_cap, stdin) != -1) {
+        line_num++;
+        trim_inplace(line);
+
+        if (line[0] == '\0' || line[0] == '#') {
             continue;
         }
 
-        trim_inplace(line);
-
-        if (strlen(line) > 0) {
-            char c = tolower((unsigned char)line[0]);
-            free(line);
+        fprintf(to_server, "%s\n", line);
+        if (fflush(to_server) != 0) {
+            fprintf(stderr, "Error: Lost the connection to the server\n");
+            status = EXIT_FAILURE;
+            break;
+        }
 
-            if (c == 'y') {
-                return 1;
+        int answered = 0;
+        while (getline(&reply, &reply_cap, from_server) != -1) {
+            if (strcmp(reply, "OK\n") == 0) {
+                answered = 1;
+                break;
             }
-
-            if (c == 'n') {
-                return 0;
+            if (strncmp(reply, "ERR ", 4) == 0) {
+                fprintf(stderr, "Error: line %zu: %s", line_num, reply + 4);
+                failed++;
+                answered = 1;
+                break;
             }
-        } else {
-            free(line);
+            fputs(reply, stdout);
+        }
+
+        if (!answered) {
+            fprintf(stderr, "Error: Lost the connection to the server\n");
+            status = EXIT_FAILURE;
+            break;
         }
-        printf("Please enter 'y' or 'n'.\n");
     }
+
+    free(line);
+    free(reply);
+    fclose(from_server);
+    fclose(to_server);
+    return (failed > 0) ? EXIT_FAILURE : status;
 }
 
-static void auto_save_prompt(StudentList *list) {
-    if (!list->modified) {
-        return;
-    }
-    
-    printf("\nYou have unsaved changes!\n");
-    
-    if (list->last_filename) {
-        printf("Last file: %s\n", list->last_filename);
+/* ---------- Command Line ---------- */
 
-        if (prompt_yes_no("Save to this file? (y/n): ")) {
-            if (save_to_file(list, list->last_filename) == SUCCESS) {
-                printf("Saved %zu records to '%s'\n", list->size, list->last_filename);
+static void print_usage(const char *program) {
+    fprintf(stderr, "Usage: %s [--collate=bytes|nocase|locale] [--threads=N] [--save=durable|fast]\n"
+                    "          [--async-save] [--serve | --client] [--socket=PATH]\n"
+                    "          [--batch [COMMANDS|-]] [--file=DATA_FILE]\n", program);
+}
+
+static ErrorCode parse_options(int argc, char **argv, ProgramOptions *opts) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    opts->collation = COLLATE_BYTES;
+    opts->scan_threads = (cpus < 1) ? 1 : (cpus > MAX_SCAN_THREADS ? MAX_SCAN_THREADS : (int)cpus);
+    opts->batch_path = NULL;
+    opts->data_file = FILENAME;
+    opts->save_mode = SAVE_DURABLE;
+    opts->async_save = 0;
+    opts->serve = 0;
+    opts->client = 0;
+    opts->socket_path = SOCKET_PATH;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+
+        if (strncmp(arg, "--collate=", 10) == 0) {
+            const char *mode = arg + 10;
+
+            if (strcmp(mode, "bytes") == 0) {
+                opts->collation = COLLATE_BYTES;
+            } else if (strcmp(mode, "nocase") == 0) {
+                opts->collation = COLLATE_NOCASE;
+            } else if (strcmp(mode, "locale") == 0) {
+                opts->collation = COLLATE_LOCALE;
+            } else {
+                fprintf(stderr, "Error: Unknown collation '%s'\n", mode);
+                return ERR_INVALID_INPUT;
             }
-        }
-    } else {
-        if (prompt_yes_no("Would you like to save to " FILENAME "? (y/n): ")) {
-            if (save_to_file(list, FILENAME) == SUCCESS) {
-                printf("Saved %zu records to '" FILENAME "'\n", list->size);
+        } else if (strncmp(arg, "--threads=", 10) == 0) {
+            char *end;
+            long n = strtol(arg + 10, &end, 10);
+
+            if (end == arg + 10 || *end != '\0' || n < 1 || n > MAX_SCAN_THREADS) {
+                fprintf(stderr, "Error: --threads must be between 1 and %d\n", MAX_SCAN_THREADS);
+                return ERR_INVALID_INPUT;
+            }
+            opts->scan_threads = (int)n;
+        } else if (strcmp(arg, "--batch") == 0) {
+            // The commands file is optional; without one they come from stdin
+            if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) {
+                opts->batch_path = argv[++i];
+            } else {
+                opts->batch_path = "-";
             }
+        } else if (strcmp(arg, "--save=durable") == 0) {
+            opts->save_mode = SAVE_DURABLE;
+        } else if (strcmp(arg, "--save=fast") == 0) {
+            opts->save_mode = SAVE_FAST;
+        } else if (strcmp(arg, "--async-save") == 0) {
+            opts->async_save = 1;
+        } else if (strcmp(arg, "--serve") == 0) {
+            opts->serve = 1;
+        } else if (strcmp(arg, "--client") == 0) {
+            opts->client = 1;
+        } else if (strncmp(arg, "--socket=", 9) == 0 && arg[9] != '\0') {
+            opts->socket_path = arg + 9;
+        } else if (strncmp(arg, "--file=", 7) == 0 && arg[7] != '\0') {
+            opts->data_file = arg + 7;
+        } else {
+            fprintf(stderr, "Error: Unknown option '%s'\n", arg);
+            return ERR_INVALID_INPUT;
         }
     }
+
+    return SUCCESS;
 }
 
-static int prompt_int(const char *prompt, int min, int max) {
-    while (1) {
-        char *line = read_line(prompt);
+/* ---------- Main Program ---------- */
 
-        if (!line) {
-            printf("Memory error. Try again.\n");
-            continue;
-        }
-        
-        trim_inplace(line);
+int main(int argc, char **argv) {
+    ProgramOptions opts;
 
-        if (strlen(line) == 0) {
-            free(line);
-            printf("Input cannot be empty. Try again.\n");
-            continue;
-        }
-        
-        char *endptr = NULL;
-        errno = 0;
-        long val = strtol(line, &endptr, 10);
-        
-        if (*endptr != '\0' || errno == ERANGE) {
-            free(line);
-            printf("Invalid number. Try again.\n");
-            continue;
-        }
-        
-        free(line);
-        
-        if (val < min || val > max) {
-            printf("Number must be between %d and %d. Try again.\n", min, max);
-            continue;
-        }
-        
-        return (int)val;
+    if (parse_options(argc, argv, &opts) != SUCCESS) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
     }
-}
 
-static ErrorCode prompt_student_input(int *out_roll, char **out_name, int *out_marks) {
-    int roll = prompt_int("Enter roll number (1-99999): ", 1, 99999);
-    
-    char *line = read_line("Enter student name: ");
+    if (opts.collation == COLLATE_LOCALE) {
+        setlocale(LC_COLLATE, "");
+    }
 
-    if (!line) {
-        return ERR_MEMORY;
+    if (opts.client) {
+        return run_client(opts.socket_path);
     }
 
-    trim_inplace(line);
+    if (opts.serve) {
+        StudentList server_list;
 
-    if (strlen(line) == 0) {
-        free(line);
-        line = safe_strdup("Unnamed");
-    } else if (strlen(line) > MAX_NAME_LENGTH) {
-        line[MAX_NAME_LENGTH] = '\0';
-        printf("Name truncated to %d characters.\n", MAX_NAME_LENGTH);
+        if (init_student_list(&server_list) != SUCCESS) {
+            fprintf(stderr, "Fatal: Memory allocation failed\n");
+            return EXIT_FAILURE;
+        }
+        server_list.collation = opts.collation;
+        server_list.save_mode = opts.save_mode;
+
+        int status = run_server(&server_list, opts.data_file, opts.socket_path);
+        free_student_list(&server_list);
+        return status;
     }
-    
-    int marks = prompt_int("Enter marks (0-100): ", 0, 100);
-    
-    *out_roll = roll;
-    *out_name = line;
-    *out_marks = marks;
-    
-    return SUCCESS;
-}
 
-/* ---------- Menu System ---------- */
+    if (opts.batch_path) {
+        StudentList batch_list;
 
-static void show_menu(void) {
-    printf("\n");
-    printf("┌────────────────────────────────────────┐\n");
-    printf("│     Student Record System Menu         │\n");
-    printf("├────────────────────────────────────────┤\n");
-    printf("│  1. Add a student                      │\n");
-    printf("│  2. Modify a student                   │\n");
-    printf("│  3. Remove a student                   │\n");
-    printf("│  4. Display all students               │\n");
-    printf("│  5. Search by roll number              │\n");
-    printf("│  6. Show statistics                    │\n");
-    printf("│  7. Sort by marks (ascending)          │\n");
-    printf("│  8. Sort by marks (descending)         │\n");
-    printf("│  9. Sort by name                       │\n");
-    printf("│ 10. Save to file                       │\n");
-    printf("│ 11. Load from file                     │\n");
-    printf("│ 12. Quick save                         │\n");
-    printf("│  0. Exit                               │\n");
-    printf("└────────────────────────────────────────┘\n");
-}
+        if (init_student_list(&batch_list) != SUCCESS) {
+            fprintf(stderr, "Fatal: Memory allocation failed\n");
+            return EXIT_FAILURE;
+        }
+        batch_list.collation = opts.collation;
+        batch_list.save_mode = opts.save_mode;
 
-/* ---------- Main Program ---------- */
+        int status = run_batch(&batch_list, opts.batch_path, opts.data_file);
+        free_student_list(&batch_list);
+        return status;
+    }
 
-int main(void) {
     printf("Welcome to Student Record System v2.0!\n\n");
     
     char *user = read_line("Please enter your name: ");
@@ -979,6 +6417,12 @@ int main(void) {
         free(user);
         return EXIT_FAILURE;
     }
+    list.collation = opts.collation;
+    list.save_mode = opts.save_mode;
+
+    if (opts.async_save && async_save_start(&list) != SUCCESS) {
+        printf("Warning: Could not start the background saver; saving normally.\n");
+    }
     
     int running = 1;
     
@@ -993,12 +6437,16 @@ int main(void) {
             printf("\n");
         }
         
-        int choice = prompt_int("Choose an option (0-12): ", 0, 12);
+        int choice = prompt_int("Choose an option (0-14): ", 0, 14);
         
         switch (choice) {
             /* These cases were added so that when adding a student, it automatically saves to file 
-               right away, so the data is persistent even if the program crashes */
+               right away, so the data is persistent even if the program crashes.
+               We sync first so a file written earlier (or by someone else) isn't overwritten
+               by a list that never saw its records */
             case 1: {
+                sync_with_file(&list, list.last_filename ? list.last_filename : FILENAME);
+
                 int roll, marks;
                 char *name;
                 if (prompt_student_input(&roll, &name, &marks) != SUCCESS) {
@@ -1006,7 +6454,7 @@ int main(void) {
                     break;
                 }
                 
-                Student *s = create_student(roll, name, marks);
+                Student *s = create_student(&list, roll, name, marks);
                 free(name);
                 
                 if (!s) {
@@ -1018,20 +6466,20 @@ int main(void) {
 
                 if (err == ERR_DUPLICATE) {
                     printf("Student with roll %d already exists!\n", roll);
-                    free_student(s);
+                    free_student(&list, s);
                 } else if (err == SUCCESS) {
                     printf("Student added successfully! [%s]\n",
                            (marks >= PASS_THRESHOLD) ? "PASS" : "FAIL");
                     
                     const char *filename = list.last_filename ? list.last_filename : FILENAME;
-                    if (save_to_file(&list, filename) == SUCCESS) {
+                    if (journal_append(&list, filename, JOURNAL_ADD, s->roll, s) == SUCCESS) {
                         printf("Student record saved to '%s'\n", filename);
                     } else {
                         printf("Warning: Student added but failed to save to file.\n");
                     }
                 } else {
                     printf("Failed to add student.\n");
-                    free_student(s);
+                    free_student(&list, s);
                 }
                 break;
             }
@@ -1039,13 +6487,9 @@ int main(void) {
                the latest data, then allow partial updates (pressing Enter keeps old values) */
             case 2: {
                 const char *filename = list.last_filename ? list.last_filename : FILENAME;
-                FILE *test_file = fopen(filename, "r");
-                if (test_file) {
-                    fclose(test_file);
-                    load_from_file(&list, filename);
-                }
+                sync_with_file(&list, filename);  // A missing file just means nothing to load yet
                 
-                int roll = prompt_int("Enter roll number to modify: ", 1, 99999);
+                int roll = prompt_int("Enter roll number to modify: ", MIN_ROLL, MAX_ROLL);
                 long idx = find_index_by_roll(&list, roll);
                 
                 if (idx < 0) {
@@ -1065,7 +6509,7 @@ int main(void) {
                 if (roll_input && strlen(roll_input) > 0) {
                     char *endptr = NULL;
                     long val = strtol(roll_input, &endptr, 10);
-                    if (*endptr == '\0' && val >= 1 && val <= 99999) {
+                    if (*endptr == '\0' && val >= MIN_ROLL && val <= MAX_ROLL) {
                         new_roll = (int)val;
                     } else {
                         printf("Invalid input, keeping current roll number.\n");
@@ -1108,7 +6552,7 @@ int main(void) {
                 } else if (err == SUCCESS) {
                     printf("Student modified successfully!\n");
                     
-                    if (save_to_file(&list, filename) == SUCCESS) {
+                    if (journal_append(&list, filename, JOURNAL_MODIFY, roll, list.items[idx]) == SUCCESS) {
                         printf("Changes saved to '%s'\n", filename);
                     } else {
                         printf("Warning: Student modified but failed to save to file.\n");
@@ -1123,13 +6567,9 @@ int main(void) {
                and saves immediately after removal so the file stays updated */
             case 3: {
                 const char *filename = list.last_filename ? list.last_filename : FILENAME;
-                FILE *test_file = fopen(filename, "r");
-                if (test_file) {
-                    fclose(test_file);
-                    load_from_file(&list, filename);
-                }
+                sync_with_file(&list, filename);  // A missing file just means nothing to load yet
                 
-                int roll = prompt_int("Enter roll number to remove: ", 1, 99999);
+                int roll = prompt_int("Enter roll number to remove: ", MIN_ROLL, MAX_ROLL);
                 long idx = find_index_by_roll(&list, roll);
                 
                 if (idx < 0) {
@@ -1143,7 +6583,7 @@ int main(void) {
                         if (remove_student_by_index(&list, (size_t)idx) == SUCCESS) {
                             printf("Student removed successfully!\n");
                             
-                            if (save_to_file(&list, filename) == SUCCESS) {
+                            if (journal_append(&list, filename, JOURNAL_DELETE, roll, NULL) == SUCCESS) {
                                 printf("Changes saved to '%s'\n", filename);
                             } else {
                                 printf("Warning: Student removed but failed to save to file.\n");
@@ -1162,6 +6602,7 @@ int main(void) {
                saved in the file, even if memory is out of sync */
             case 4: {
                 const char *filename = list.last_filename ? list.last_filename : FILENAME;
+                compact_journal(&list, filename);
                 ErrorCode err = display_from_file(filename);
                 if (err == ERR_FILE_IO) {
                     printf("File '%s' not found or cannot be read.\n", filename);
@@ -1174,6 +6615,7 @@ int main(void) {
                so we don't need to load everything into memory first */
             case 5: {
                 const char *filename = list.last_filename ? list.last_filename : FILENAME;
+                compact_journal(&list, filename);
                 
                 FILE *test_file = fopen(filename, "r");
                 if (!test_file) {
@@ -1183,7 +6625,7 @@ int main(void) {
                 }
                 fclose(test_file);
                 
-                int roll = prompt_int("Enter roll number to search: ", 1, 99999);
+                int roll = prompt_int("Enter roll number to search: ", MIN_ROLL, MAX_ROLL);
                 ErrorCode err = search_in_file(filename, roll);
                 
                 if (err == ERR_FILE_IO) {
@@ -1195,9 +6637,16 @@ int main(void) {
             }
             
             /* This block calculates statistics by reading directly from file, so we get 
-               accurate stats based on what's actually saved, not what's in memory */
+               accurate stats based on what's actually saved, not what's in memory.
+               When memory already matches the file, the running totals answer instantly */
             case 6: {
                 const char *filename = list.last_filename ? list.last_filename : FILENAME;
+                compact_journal(&list, filename);
+
+                if (list_in_sync(&list, filename)) {
+                    display_statistics(&list, stdout);
+                    break;
+                }
                 
                 FILE *test_file = fopen(filename, "r");
                 if (!test_file) {
@@ -1207,7 +6656,7 @@ int main(void) {
                 }
                 fclose(test_file);
                 
-                ErrorCode err = statistics_from_file(filename);
+                ErrorCode err = statistics_from_file(filename, opts.scan_threads);
                 if (err == ERR_FILE_IO) {
                     printf("Failed to read from file '%s'.\n", filename);
                 }
@@ -1219,15 +6668,14 @@ int main(void) {
             case 7: {
                 const char *filename = list.last_filename ? list.last_filename : FILENAME;
                 
-                FILE *test_file = fopen(filename, "r");
-                if (!test_file) {
+                ErrorCode sync_err = sync_with_file(&list, filename);
+                if (sync_err == ERR_FILE_IO) {
                     printf("Error: File '%s' not found.\n", filename);
                     printf("Make sure you have added students first (option 1).\n");
                     break;
                 }
-                fclose(test_file);
-                
-                if (load_from_file(&list, filename) != SUCCESS) {
+
+                if (sync_err != SUCCESS) {
                     printf("Failed to load from file.\n");
                     break;
                 }
@@ -1237,11 +6685,15 @@ int main(void) {
                     break;
                 }
                 
-                sort_students(&list, cmp_marks_asc);
+                // The sorted view is walked for display; items only change if it is saved
                 printf("\nSorted by marks (ascending):\n");
-                display_all_students(&list);
+                if (display_all_students(&list, VIEW_MARKS_ASC) != SUCCESS) {
+                    printf("Not enough memory to sort the students.\n");
+                    break;
+                }
                 
                 if (prompt_yes_no("\nSave sorted order to file? (y/n): ")) {
+                    sort_students(&list, cmp_marks_asc);
                     if (save_to_file(&list, filename) == SUCCESS) {
                         printf("Sorted data saved to '%s'\n", filename);
                     } else {
@@ -1256,15 +6708,14 @@ int main(void) {
             case 8: {
                 const char *filename = list.last_filename ? list.last_filename : FILENAME;
                 
-                FILE *test_file = fopen(filename, "r");
-                if (!test_file) {
+                ErrorCode sync_err = sync_with_file(&list, filename);
+                if (sync_err == ERR_FILE_IO) {
                     printf("Error: File '%s' not found.\n", filename);
                     printf("Make sure you have added students first (option 1).\n");
                     break;
                 }
-                fclose(test_file);
-                
-                if (load_from_file(&list, filename) != SUCCESS) {
+
+                if (sync_err != SUCCESS) {
                     printf("Failed to load from file.\n");
                     break;
                 }
@@ -1274,11 +6725,15 @@ int main(void) {
                     break;
                 }
                 
-                sort_students(&list, cmp_marks_desc);
+                // The sorted view is walked for display; items only change if it is saved
                 printf("\nSorted by marks (descending):\n");
-                display_all_students(&list);
+                if (display_all_students(&list, VIEW_MARKS_DESC) != SUCCESS) {
+                    printf("Not enough memory to sort the students.\n");
+                    break;
+                }
                 
                 if (prompt_yes_no("\nSave sorted order to file? (y/n): ")) {
+                    sort_students(&list, cmp_marks_desc);
                     if (save_to_file(&list, filename) == SUCCESS) {
                         printf("Sorted data saved to '%s'\n", filename);
                     } else {
@@ -1293,15 +6748,14 @@ int main(void) {
             case 9: {
                 const char *filename = list.last_filename ? list.last_filename : FILENAME;
                 
-                FILE *test_file = fopen(filename, "r");
-                if (!test_file) {
+                ErrorCode sync_err = sync_with_file(&list, filename);
+                if (sync_err == ERR_FILE_IO) {
                     printf("Error: File '%s' not found.\n", filename);
                     printf("Make sure you have added students first (option 1).\n");
                     break;
                 }
-                fclose(test_file);
-                
-                if (load_from_file(&list, filename) != SUCCESS) {
+
+                if (sync_err != SUCCESS) {
                     printf("Failed to load from file.\n");
                     break;
                 }
@@ -1311,11 +6765,15 @@ int main(void) {
                     break;
                 }
                 
-                sort_students(&list, cmp_name_asc);
+                // The sorted view is walked for display; items only change if it is saved
                 printf("\nSorted by name (alphabetically):\n");
-                display_all_students(&list);
+                if (display_all_students(&list, VIEW_NAME) != SUCCESS) {
+                    printf("Not enough memory to sort the students.\n");
+                    break;
+                }
                 
                 if (prompt_yes_no("\nSave sorted order to file? (y/n): ")) {
+                    sort_students(&list, cmp_name_asc);
                     if (save_to_file(&list, filename) == SUCCESS) {
                         printf("Sorted data saved to '%s'\n", filename);
                     } else {
@@ -1346,7 +6804,7 @@ int main(void) {
                         printf("Failed to save to '%s'\n", default_filename);
                     }
                 } else {
-                    char *custom_filename = read_line("Enter filename (or press Enter for default): ");
+                    char *custom_filename = read_line("Enter filename (" BINARY_EXTENSION " saves in binary format, or press Enter for default): ");
                     if (custom_filename) {
                         trim_inplace(custom_filename);
                         if (strlen(custom_filename) == 0) {
@@ -1429,6 +6887,78 @@ int main(void) {
                 break;
             }
 
+            /* Only the best or worst few students are needed here, so this selects them
+               without sorting everything (from memory when it matches the file) */
+            case 13: {
+                const char *filename = list.last_filename ? list.last_filename : FILENAME;
+                compact_journal(&list, filename);
+
+                int k = prompt_int("How many students? ", 1, MAX_ROLL);
+                int top = prompt_yes_no("Show the highest marks? (y = top, n = bottom): ");
+                ErrorCode err;
+
+                if (list_in_sync(&list, filename)) {
+                    err = display_top_k(&list, (size_t)k, top);
+                } else {
+                    err = top_k_from_file(filename, (size_t)k, top, list.collation);
+                }
+
+                if (err == ERR_FILE_IO) {
+                    printf("Error: File '%s' not found or cannot be read.\n", filename);
+                    printf("Make sure you have added students first (option 1).\n");
+                } else if (err == ERR_MEMORY) {
+                    printf("Not enough memory to rank the students.\n");
+                }
+                break;
+            }
+
+            /* Many records at once: they are all checked for duplicates together and then
+               written with one full save instead of one journal entry each */
+            case 14: {
+                const char *filename = list.last_filename ? list.last_filename : FILENAME;
+                sync_with_file(&list, filename);
+
+                char *source = read_line("Enter filename to import: ");
+                if (!source) {
+                    break;
+                }
+                trim_inplace(source);
+
+                if (strlen(source) == 0) {
+                    printf("Invalid filename.\n");
+                    free(source);
+                    break;
+                }
+
+                int policy = prompt_int("When a roll number repeats (1 = keep first, 2 = keep last, "
+                                        "3 = cancel the import): ", 1, 3);
+                ImportSummary summary;
+                ErrorCode err = import_from_file(&list, source, (ImportPolicy)(policy - 1), &summary);
+
+                if (err == SUCCESS) {
+                    printf("Imported %zu new and %zu replaced records (%zu duplicates skipped, "
+                           "%zu invalid rows)\n", summary.added, summary.replaced,
+                           summary.skipped, summary.invalid);
+
+                    if (list.modified) {
+                        if (save_to_file(&list, filename) == SUCCESS) {
+                            printf("Saved %zu records to '%s'\n", list.size, filename);
+                        } else {
+                            printf("Warning: Records imported but failed to save to file.\n");
+                        }
+                    }
+                } else if (err == ERR_DUPLICATE) {
+                    printf("Import cancelled because of duplicate roll numbers; nothing was added.\n");
+                } else if (err == ERR_FILE_IO) {
+                    printf("Failed to read from '%s'.\n", source);
+                } else {
+                    printf("Not enough memory to import the records.\n");
+                }
+
+                free(source);
+                break;
+            }
+
             case 0:
                 running = 0;
                 printf("\nExiting...\n");